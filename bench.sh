@@ -0,0 +1,106 @@
+#!/bin/sh
+#
+# Runs every benchmark, writing one line of key=value pairs per
+# result to the results file, then compares the results with a
+# baseline saved by `make bench-baseline`, if there is one.
+#
+# Lines are matched on their non-numeric fields. Keys ending in
+# _per_sec are better higher, keys ending in _ns or _ms are better
+# lower, and anything else is a parameter.
+#
+# Usage: ./bench.sh results_file baseline_file
+
+RESULTS=${1:-bench.out}
+BASELINE=${2:-bench_baseline.out}
+THRESHOLD=10 # Percent worse than the baseline that counts as a regression
+PROCS=2000   # Processes in each end-to-end run
+DIR=$(cd "$(dirname "$0")" && pwd)
+PATH=$DIR:$PATH
+export PATH
+
+# Nanoseconds since the epoch
+now() {
+  date +%s%N
+}
+
+# Simulated events per wall-clock second of whole oss runs
+run_oss() {
+  policy=$1
+  users=${2:-pool}
+  work=$(mktemp -d)
+  start=$(now)
+  (cd "$work" && "$DIR/oss" -s 1 -n $PROCS -p "$policy" -u "$users" -t oss.trace) || exit 1
+  end=$(now)
+  events=$(sed -n 's/^Events Handled: \([0-9]*\).*/\1/p' "$work/oss.out")
+  rm -rf "$work"
+  awk -v policy="$policy" -v users="$users" -v procs=$PROCS -v events="$events" \
+      -v ns=$((end - start)) 'BEGIN {
+    printf "run=oss policy=%s users=%s procs=%d events=%d wall_ms=%.1f events_per_sec=%.0f\n",
+           policy, users, procs, events, ns / 1e6, events / (ns / 1e9)
+  }'
+}
+
+{
+  "$DIR/bench_queue" -i 5000000
+  "$DIR/bench_handoff" -m spin -i 100 # Spinning children share the cores
+  "$DIR/bench_handoff" -m futex
+  "$DIR/bench_spawn"
+  "$DIR/bench_contention"
+  for policy in mlfq cfs srtf stride; do
+    run_oss $policy
+  done
+  run_oss mlfq spawn
+  run_oss mlfq thread
+} > "$RESULTS" || exit 1
+
+cat "$RESULTS"
+
+if [ ! -f "$BASELINE" ]; then
+  echo "No baseline in $BASELINE; save one with make bench-baseline."
+  exit 0
+fi
+
+echo
+echo "Compared with $BASELINE:"
+awk -v threshold=$THRESHOLD '
+  # The non-numeric fields of a line, which name the result
+  function identity(    i, id) {
+    id = ""
+    for (i = 1; i <= NF; i++) {
+      split($i, kv, "=")
+      if (kv[2] !~ /^[0-9.]+$/) {
+        id = id " " $i
+      }
+    }
+    return id
+  }
+  FNR == NR {
+    id = identity()
+    for (i = 1; i <= NF; i++) {
+      split($i, kv, "=")
+      baseline[id, kv[1]] = kv[2]
+    }
+    next
+  }
+  {
+    id = identity()
+    for (i = 1; i <= NF; i++) {
+      split($i, kv, "=")
+      key = kv[1]
+      if (key ~ /_per_sec$/) {
+        sign = 1
+      } else if (key ~ /_(ns|ms)$/) {
+        sign = -1
+      } else {
+        continue
+      }
+      if (!((id, key) in baseline) || baseline[id, key] == 0) {
+        continue
+      }
+      change = 100 * (kv[2] - baseline[id, key]) / baseline[id, key]
+      flag = sign * change < -threshold ? "  REGRESSION" : ""
+      printf "%s %s: %s -> %s (%+.1f%%)%s\n", substr(id, 2), key,
+             baseline[id, key], kv[2], change, flag
+    }
+  }
+' "$BASELINE" "$RESULTS"
@@ -0,0 +1,174 @@
+/**
+ * PCB Contention Benchmark
+ *
+ * Measures how fast many children running at the same time can
+ * update their own PCBs while the parent, like oss, keeps reading
+ * every PCB's ready_to_terminate. The packed layout is the original
+ * PCB, where neighbouring slots share cache lines. The padded layout
+ * is the current one, where every slot has lines of its own.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "structs.h"
+#include "futex.h"
+
+/*
+ * The original PCB, packed contiguously
+ * -------------------------------------*/
+struct packed_pcb {
+  uint64_t total_cpu_time;
+  uint64_t total_sys_time;
+  unsigned int last_burst_time;
+  int priority;
+  unsigned char was_interrupted;
+  unsigned int remaining_time;
+  unsigned char ready_to_terminate;
+};
+
+/*
+ * Where a layout keeps the fields the benchmark touches
+ * -----------------------------------------------------*/
+struct layout {
+  const char* name;
+  size_t size;
+  size_t total_cpu_time_offset;
+  size_t last_burst_time_offset;
+  size_t ready_to_terminate_offset;
+};
+
+static const struct layout layouts[] = {
+  {
+    "packed",
+    sizeof(struct packed_pcb),
+    offsetof(struct packed_pcb, total_cpu_time),
+    offsetof(struct packed_pcb, last_burst_time),
+    offsetof(struct packed_pcb, ready_to_terminate)
+  },
+  {
+    "padded",
+    sizeof(struct pcb),
+    offsetof(struct pcb, total_cpu_time),
+    offsetof(struct pcb, last_burst_time),
+    offsetof(struct pcb, ready_to_terminate)
+  }
+};
+
+/*
+ * What the children share with the parent
+ * ---------------------------------------*/
+struct shared {
+  int go_word; // Futex word the parent sets to start every child
+
+  // The PCB table, in either layout, starting on a line of its own
+  // as it does in the arena, see ossshm.h
+  char pcbs[] __attribute__((aligned(CACHE_LINE_SIZE)));
+};
+
+static double run(const struct layout* layout, int num_children, long num_writes);
+static double get_elapsed_secs(struct timespec a, struct timespec b);
+
+int main(int argc, char* argv[]) {
+  int num_children = 8;
+  long num_writes = 2000000;
+  int c;
+
+  while ((c = getopt(argc, argv, "n:i:")) != -1) {
+    switch (c) {
+      case 'n':
+        num_children = atoi(optarg);
+        break;
+      case 'i':
+        num_writes = atol(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-n children] [-i writes per child]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  long total_writes = num_writes * num_children;
+  int i;
+  for (i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+    double secs = run(&layouts[i], num_children, num_writes);
+    printf("layout=%s children=%d pcb_bytes=%zu writes=%ld mwrites_per_sec=%.2f\n",
+           layouts[i].name, num_children, layouts[i].size, total_writes,
+           total_writes / secs / 1e6);
+  }
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Child i writes the burst fields of PCB i num_writes times, then
+ * sets its ready_to_terminate. The parent polls every PCB's
+ * ready_to_terminate until all of them are set.
+ *
+ * @return How long it took (in seconds)
+ */
+static double run(const struct layout* layout, int num_children, long num_writes) {
+  size_t size = sizeof(struct shared) + layout->size * num_children;
+  struct shared* shared = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("Failed to map the PCB table");
+    exit(EXIT_FAILURE);
+  }
+  memset(shared, 0, size);
+
+  int i;
+  for (i = 0; i < num_children; i++) {
+    pid_t pid = fork();
+    if (pid == -1) {
+      perror("Failed to fork");
+      exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+      char* pcb = shared->pcbs + layout->size * i;
+      uint64_t* total_cpu_time = (uint64_t*) (pcb + layout->total_cpu_time_offset);
+      unsigned int* last_burst_time =
+        (unsigned int*) (pcb + layout->last_burst_time_offset);
+      while (__atomic_load_n(&shared->go_word, __ATOMIC_ACQUIRE) == 0) {
+        futex_wait(&shared->go_word, 0);
+      }
+      long n;
+      for (n = 0; n < num_writes; n++) {
+        uint64_t cpu_time = __atomic_load_n(total_cpu_time, __ATOMIC_RELAXED);
+        __atomic_store_n(total_cpu_time, cpu_time + n, __ATOMIC_RELAXED);
+        __atomic_store_n(last_burst_time, (unsigned int) n, __ATOMIC_RELAXED);
+      }
+      __atomic_store_n(pcb + layout->ready_to_terminate_offset, 1, __ATOMIC_RELEASE);
+      _exit(EXIT_SUCCESS);
+    }
+  }
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  __atomic_store_n(&shared->go_word, 1, __ATOMIC_RELEASE);
+  futex_wake(&shared->go_word, INT_MAX);
+
+  int num_done;
+  do {
+    num_done = 0;
+    for (i = 0; i < num_children; i++) {
+      char* pcb = shared->pcbs + layout->size * i;
+      num_done += __atomic_load_n(pcb + layout->ready_to_terminate_offset,
+                                  __ATOMIC_ACQUIRE);
+    }
+  } while (num_done < num_children);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  while (wait(NULL) > 0);
+  munmap(shared, size);
+  return get_elapsed_secs(start, end);
+}
+
+static double get_elapsed_secs(struct timespec a, struct timespec b) {
+  return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
+}
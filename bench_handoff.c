@@ -0,0 +1,189 @@
+/**
+ * Dispatch Handoff Benchmark
+ *
+ * Measures the wall-clock latency between oss dispatching a
+ * process and that process starting to run, along with the CPU
+ * time burned by everyone while waiting. Compares the old busy-wait
+ * on curr_sched_shm->proc_id against per-PCB futex wait words.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include "structs.h"
+#include "sem.h"
+#include "ossshm.h"
+#include "futex.h"
+
+#define NOT_A_PROC_ID -10
+
+/*
+ * Shared statistics written by whichever child is running.
+ * Only one child runs at a time, so no locking is needed.
+ * ---------------------------------------------------------*/
+struct handoff_stats {
+  struct timespec dispatched_at;
+  long long total_latency;   // in nanoseconds
+  long long max_latency;     // in nanoseconds
+  int should_exit;
+};
+
+static long long get_elapsed_nanosecs(struct timespec a, struct timespec b);
+static double get_cpu_millisecs(int who);
+static void run_child(int proc_id, int use_futex, struct pcb* pcb_shm,
+                      struct curr_sched* curr_sched_shm,
+                      struct handoff_stats* stats, int sem_id);
+
+int main(int argc, char* argv[]) {
+  int use_futex = 1;
+  int num_children = 4;
+  int num_iterations = 2000;
+  int c;
+
+  while ((c = getopt(argc, argv, "m:n:i:")) != -1) {
+    switch (c) {
+      case 'm':
+        use_futex = strcmp(optarg, "spin") != 0;
+        break;
+      case 'n':
+        num_children = atoi(optarg);
+        break;
+      case 'i':
+        num_iterations = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-m spin|futex] [-n children] [-i iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  int sem_id = allocate_sem(IPC_PRIVATE, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
+  if (sem_id == -1 || init_sem(sem_id, 0) == -1) {
+    perror("Failed to set up binary semaphore");
+    return EXIT_FAILURE;
+  }
+
+  // The children are forked, so they keep the mapping without the name
+  char shm_name[32];
+  sprintf(shm_name, "/bench_handoff.%d", getpid());
+  struct oss_shm shm;
+  create_oss_shm(&shm, shm_name, num_children, 1, 0);
+  remove_oss_shm(shm_name);
+  struct pcb* pcb_shm = shm.pcbs;
+  struct curr_sched* curr_sched_shm = shm.curr_sched;
+  curr_sched_shm->proc_id = NOT_A_PROC_ID;
+
+  int stats_seg_id = shmget(IPC_PRIVATE, sizeof(struct handoff_stats),
+    IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
+  if (stats_seg_id == -1) {
+    perror("Failed to get shared memory for statistics");
+    return EXIT_FAILURE;
+  }
+  struct handoff_stats* stats = shmat(stats_seg_id, NULL, 0);
+  memset(stats, 0, sizeof(struct handoff_stats));
+
+  int i;
+  for (i = 0; i < num_children; i++) {
+    pid_t pid = fork();
+    if (pid == -1) {
+      perror("Failed to fork");
+      exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+      run_child(i, use_futex, pcb_shm, curr_sched_shm, stats, sem_id);
+      _exit(EXIT_SUCCESS);
+    }
+  }
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (i = 0; i < num_iterations + num_children; i++) {
+    int proc_id = i % num_children;
+    // The last round tells every child to exit
+    stats->should_exit = i >= num_iterations;
+    clock_gettime(CLOCK_MONOTONIC, &stats->dispatched_at);
+    if (use_futex) {
+      curr_sched_shm->proc_id = proc_id;
+      wakeup_post(&pcb_shm[proc_id].wait_word);
+    } else {
+      __atomic_store_n(&curr_sched_shm->proc_id, proc_id, __ATOMIC_RELEASE);
+    }
+    sem_wait(sem_id);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  while (wait(NULL) > 0);
+
+  double wall_millisecs = get_elapsed_nanosecs(start, end) / 1e6;
+  double cpu_millisecs = get_cpu_millisecs(RUSAGE_SELF) +
+                         get_cpu_millisecs(RUSAGE_CHILDREN);
+  long long num_handoffs = num_iterations + num_children;
+
+  printf(
+    "mode=%s children=%d handoffs=%lld avg_latency_ns=%lld max_latency_ns=%lld "
+    "wall_ms=%.1f cpu_ms=%.1f cpu_per_wall=%.2f\n",
+    use_futex ? "futex" : "spin",
+    num_children,
+    num_handoffs,
+    stats->total_latency / num_handoffs,
+    stats->max_latency,
+    wall_millisecs,
+    cpu_millisecs,
+    cpu_millisecs / wall_millisecs
+  );
+
+  shmdt(stats);
+  shmctl(stats_seg_id, IPC_RMID, 0);
+  detach_from_oss_shm(&shm);
+  deallocate_sem(sem_id);
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Wait to be dispatched, record the handoff latency and
+ * hand control back to the parent, until told to exit.
+ */
+static void run_child(int proc_id, int use_futex, struct pcb* pcb_shm,
+                      struct curr_sched* curr_sched_shm,
+                      struct handoff_stats* stats, int sem_id) {
+  int should_exit = 0;
+  while (!should_exit) {
+    if (use_futex) {
+      wakeup_wait(&pcb_shm[proc_id].wait_word);
+    } else {
+      while (__atomic_load_n(&curr_sched_shm->proc_id, __ATOMIC_ACQUIRE) != proc_id);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long latency = get_elapsed_nanosecs(stats->dispatched_at, now);
+    stats->total_latency += latency;
+    if (latency > stats->max_latency) {
+      stats->max_latency = latency;
+    }
+    should_exit = stats->should_exit;
+
+    __atomic_store_n(&curr_sched_shm->proc_id, NOT_A_PROC_ID, __ATOMIC_RELEASE);
+    sem_post(sem_id);
+  }
+}
+
+static long long get_elapsed_nanosecs(struct timespec a, struct timespec b) {
+  return (b.tv_sec - a.tv_sec) * 1000000000LL + (b.tv_nsec - a.tv_nsec);
+}
+
+static double get_cpu_millisecs(int who) {
+  struct rusage usage;
+  getrusage(who, &usage);
+  return usage.ru_utime.tv_sec * 1e3 + usage.ru_utime.tv_usec / 1e3 +
+         usage.ru_stime.tv_sec * 1e3 + usage.ru_stime.tv_usec / 1e3;
+}
@@ -0,0 +1,177 @@
+/**
+ * Ready Queue Benchmark
+ *
+ * Measures enqueue/dequeue throughput of the multi-level feedback
+ * queue. The legacy version mallocs a TAILQ entry on every enqueue,
+ * frees it on every dequeue and scans the levels in order, like the
+ * original three hard-wired queues. The current version keeps
+ * intrusive links indexed by process ID and never allocates.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/queue.h>
+#include "mlfq.h"
+
+/*
+ * Legacy malloc'd TAILQ ready queues
+ * ----------------------------------*/
+struct legacy_entry {
+  int proc_id;
+  uint64_t enqueued_at;
+  TAILQ_ENTRY(legacy_entry) entries;
+};
+
+TAILQ_HEAD(legacy_level, legacy_entry);
+
+struct legacy_mlfq {
+  int num_levels;
+  struct legacy_level* levels;
+};
+
+static void legacy_init(struct legacy_mlfq* q, int num_levels);
+static void legacy_enqueue(struct legacy_mlfq* q, int proc_id, int level,
+                           uint64_t now);
+static int legacy_dequeue(struct legacy_mlfq* q, int* level);
+static double run_legacy(int num_procs, int num_levels, long num_ops);
+static double run_current(int num_procs, int num_levels, long num_ops);
+static double get_elapsed_secs(struct timespec a, struct timespec b);
+
+static unsigned int seed = 1;
+
+/**
+ * Small linear congruential generator, so both versions
+ * see exactly the same sequence of levels.
+ */
+static int next_level(int num_levels) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % num_levels;
+}
+
+int main(int argc, char* argv[]) {
+  int num_procs = 18;
+  int num_levels = 3;
+  long num_ops = 10000000;
+  int c;
+
+  while ((c = getopt(argc, argv, "n:q:i:")) != -1) {
+    switch (c) {
+      case 'n':
+        num_procs = atoi(optarg);
+        break;
+      case 'q':
+        num_levels = atoi(optarg);
+        break;
+      case 'i':
+        num_ops = atol(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-n procs] [-q levels] [-i operations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  double legacy_secs = run_legacy(num_procs, num_levels, num_ops);
+  double current_secs = run_current(num_procs, num_levels, num_ops);
+
+  printf("queue=legacy procs=%d levels=%d ops=%ld mops_per_sec=%.2f\n",
+         num_procs, num_levels, num_ops, num_ops / legacy_secs / 1e6);
+  printf("queue=intrusive procs=%d levels=%d ops=%ld mops_per_sec=%.2f\n",
+         num_procs, num_levels, num_ops, num_ops / current_secs / 1e6);
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Fills the queue, then repeatedly dequeues the highest priority
+ * process and enqueues it again at a pseudo-random level.
+ * An operation is one dequeue plus one enqueue.
+ */
+static double run_legacy(int num_procs, int num_levels, long num_ops) {
+  struct legacy_mlfq q;
+  uint64_t now = 0;
+  struct timespec start, end;
+  int i, level;
+  long op;
+
+  legacy_init(&q, num_levels);
+  seed = 1;
+  for (i = 0; i < num_procs; i++) {
+    legacy_enqueue(&q, i, next_level(num_levels), now);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (op = 0; op < num_ops; op++) {
+    int proc_id = legacy_dequeue(&q, &level);
+    legacy_enqueue(&q, proc_id, next_level(num_levels), now);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  while (legacy_dequeue(&q, &level) != -1);
+  free(q.levels);
+  return get_elapsed_secs(start, end);
+}
+
+static double run_current(int num_procs, int num_levels, long num_ops) {
+  struct my_mlfq q;
+  uint64_t now = 0;
+  struct timespec start, end;
+  uint64_t wait;
+  int i, level;
+  long op;
+
+  init_mlfq(&q, num_levels, num_procs, MY_TIMESLICE);
+  seed = 1;
+  for (i = 0; i < num_procs; i++) {
+    mlfq_enqueue(&q, i, next_level(num_levels), now);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (op = 0; op < num_ops; op++) {
+    int proc_id = mlfq_dequeue(&q, &level, now, &wait);
+    mlfq_enqueue(&q, proc_id, next_level(num_levels), now);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  free_mlfq(&q);
+  return get_elapsed_secs(start, end);
+}
+
+static void legacy_init(struct legacy_mlfq* q, int num_levels) {
+  q->num_levels = num_levels;
+  q->levels = malloc(sizeof(struct legacy_level) * num_levels);
+  int i;
+  for (i = 0; i < num_levels; i++) {
+    TAILQ_INIT(&q->levels[i]);
+  }
+}
+
+static void legacy_enqueue(struct legacy_mlfq* q, int proc_id, int level,
+                           uint64_t now) {
+  struct legacy_entry* proc = malloc(sizeof(struct legacy_entry));
+  proc->proc_id = proc_id;
+  proc->enqueued_at = now;
+  TAILQ_INSERT_TAIL(&q->levels[level], proc, entries);
+}
+
+static int legacy_dequeue(struct legacy_mlfq* q, int* level) {
+  int i;
+  for (i = 0; i < q->num_levels; i++) {
+    struct legacy_entry* np = TAILQ_FIRST(&q->levels[i]);
+    if (np != NULL) {
+      int proc_id = np->proc_id;
+      TAILQ_REMOVE(&q->levels[i], np, entries);
+      free(np);
+      *level = i;
+      return proc_id;
+    }
+  }
+  return -1;
+}
+
+static double get_elapsed_secs(struct timespec a, struct timespec b) {
+  return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
+}
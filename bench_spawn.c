@@ -0,0 +1,162 @@
+/**
+ * Process Spawn Benchmark
+ *
+ * Measures the cost of creating a simulated process each way oss
+ * can. fork_exec forks and execs user the way oss used to, and
+ * vfork_exec is oss's -u spawn. For both, user is run without
+ * arguments, so it exits as soon as it starts, and the benchmark
+ * waits for each child before starting the next.
+ *
+ * pool is oss's -u pool: a single worker, started once, is given
+ * one process after another in its PCB slot and dispatched until
+ * the process terminates. That includes a couple of dispatch
+ * handoffs on top of the creation the other modes measure.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "structs.h"
+#include "ossshm.h"
+#include "futex.h"
+#include "mlfq.h"
+
+#define FIFTY_MILLISECS 50000000 // 50 milliseconds in nano seconds
+
+static double run_exec(int num_spawns, int use_vfork);
+static double run_pool(int num_spawns);
+static void print_result(const char* mode, int num_spawns, double secs);
+static double get_elapsed_secs(struct timespec a, struct timespec b);
+
+int main(int argc, char* argv[]) {
+  const char* mode = NULL; // Every mode
+  int num_spawns = 500;
+  int c;
+
+  while ((c = getopt(argc, argv, "m:i:")) != -1) {
+    switch (c) {
+      case 'm':
+        mode = optarg;
+        break;
+      case 'i':
+        num_spawns = atoi(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-m fork_exec|vfork_exec|pool] [-i spawns]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+
+  if (mode == NULL || strcmp(mode, "fork_exec") == 0) {
+    print_result("fork_exec", num_spawns, run_exec(num_spawns, 0));
+  }
+  if (mode == NULL || strcmp(mode, "vfork_exec") == 0) {
+    print_result("vfork_exec", num_spawns, run_exec(num_spawns, 1));
+  }
+  if (mode == NULL || strcmp(mode, "pool") == 0) {
+    print_result("pool", num_spawns, run_pool(num_spawns));
+  }
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Starts user and waits for it to exit, num_spawns times.
+ */
+static double run_exec(int num_spawns, int use_vfork) {
+  // Hide user's usage message
+  int null_fd = open("/dev/null", O_WRONLY);
+  int stderr_fd = dup(STDERR_FILENO);
+  dup2(null_fd, STDERR_FILENO);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  int i;
+  for (i = 0; i < num_spawns; i++) {
+    pid_t pid = use_vfork ? vfork() : fork();
+    if (pid == -1) {
+      perror("Failed to fork");
+      exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+      execlp("user", "user", (char*) NULL);
+      _exit(EXIT_FAILURE);
+    }
+    waitpid(pid, NULL, 0);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  dup2(stderr_fd, STDERR_FILENO);
+  close(stderr_fd);
+  close(null_fd);
+  return get_elapsed_secs(start, end);
+}
+
+/**
+ * Gives a pooled worker num_spawns processes, one after another,
+ * dispatching each until it terminates.
+ */
+static double run_pool(int num_spawns) {
+  char shm_name[32];
+  sprintf(shm_name, "/bench_spawn.%d", getpid());
+  struct oss_shm shm;
+  create_oss_shm(&shm, shm_name, 1, 1, 0);
+  struct pcb* pcb_shm = shm.pcbs;
+  struct curr_sched* curr_sched_shm = shm.curr_sched;
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    perror("Failed to fork");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    execlp("user", "user", "0", shm_name, "1", "pool", (char*) NULL);
+    perror("Failed to exec");
+    _exit(EXIT_FAILURE);
+  }
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  int i;
+  for (i = 0; i < num_spawns; i++) {
+    unsigned int generation = pcb_shm->generation + 1;
+    memset(pcb_shm, 0, sizeof(struct pcb));
+    pcb_shm->generation = generation;
+    // Every burst that runs normally may be the last
+    pcb_shm->total_cpu_time = FIFTY_MILLISECS;
+    wakeup_post(&pcb_shm->start_word);
+
+    while (!pcb_shm->ready_to_terminate) {
+      curr_sched_shm->proc_id = 0;
+      curr_sched_shm->time_quantum = MY_TIMESLICE;
+      curr_sched_shm->rand_sched_num = 1;
+      wakeup_post(&pcb_shm->wait_word);
+      wakeup_wait(&curr_sched_shm->done_word);
+      pcb_shm->log.tail = pcb_shm->log.head; // Nobody reads the log
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  pcb_shm->should_exit = 1;
+  wakeup_post(&pcb_shm->start_word);
+  waitpid(pid, NULL, 0);
+
+  detach_from_oss_shm(&shm);
+  remove_oss_shm(shm_name);
+  return get_elapsed_secs(start, end);
+}
+
+static void print_result(const char* mode, int num_spawns, double secs) {
+  printf("spawn=%s spawns=%d avg_spawn_ns=%.0f spawns_per_sec=%.0f\n",
+         mode, num_spawns, secs * 1e9 / num_spawns, num_spawns / secs);
+}
+
+static double get_elapsed_secs(struct timespec a, struct timespec b) {
+  return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
+}
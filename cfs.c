@@ -0,0 +1,365 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "cfs.h"
+
+static void* allocate(size_t size);
+static void rotate_left(struct cfs_rq* q, int x);
+static void rotate_right(struct cfs_rq* q, int x);
+static void insert_fixup(struct cfs_rq* q, int z);
+static void erase(struct cfs_rq* q, int z);
+static void erase_fixup(struct cfs_rq* q, int x);
+static void transplant(struct cfs_rq* q, int u, int v);
+static int get_minimum(struct cfs_rq* q, int x);
+static int get_successor(struct cfs_rq* q, int x);
+
+/**
+ * Initializes an empty run queue.
+ *
+ * @param q The run queue
+ * @param num_procs Number of process IDs the run queue can hold
+ */
+void init_cfs_rq(struct cfs_rq* q, int num_procs) {
+  int num_nodes = num_procs + 1; // Plus the sentinel
+  q->left = allocate(sizeof(int) * num_nodes);
+  q->right = allocate(sizeof(int) * num_nodes);
+  q->parent = allocate(sizeof(int) * num_nodes);
+  q->is_red = allocate(sizeof(unsigned char) * num_nodes);
+  q->vruntime = allocate(sizeof(uint64_t) * num_nodes);
+  q->weight = allocate(sizeof(unsigned int) * num_nodes);
+  q->enqueued_at = allocate(sizeof(uint64_t) * num_nodes);
+
+  q->nil = num_procs;
+  q->is_red[q->nil] = 0;
+  q->root = q->nil;
+  q->leftmost = q->nil;
+  q->num_running = 0;
+  q->load_weight = 0;
+  q->min_vruntime = 0;
+}
+
+void free_cfs_rq(struct cfs_rq* q) {
+  free(q->left);
+  free(q->right);
+  free(q->parent);
+  free(q->is_red);
+  free(q->vruntime);
+  free(q->weight);
+  free(q->enqueued_at);
+}
+
+/**
+ * Inserts a runnable process. A process that slept or is new
+ * can't be behind min_vruntime, or it would have the CPU to
+ * itself until it caught up.
+ *
+ * @param q The run queue
+ * @param proc_id The process, which must not already be in the tree
+ * @param vruntime Its virtual runtime (in nanoseconds)
+ * @param weight Its share of the CPU, NICE_0_WEIGHT by default
+ * @param now Current simulated time, to measure its wait
+ * @return The virtual runtime the process was inserted with.
+ */
+uint64_t cfs_enqueue(struct cfs_rq* q, int proc_id, uint64_t vruntime,
+                     unsigned int weight, uint64_t now) {
+  if (vruntime < q->min_vruntime) {
+    vruntime = q->min_vruntime;
+  }
+  q->vruntime[proc_id] = vruntime;
+  q->weight[proc_id] = weight;
+  q->enqueued_at[proc_id] = now;
+
+  // Walk down to a leaf. Equal keys go right, after earlier arrivals.
+  int y = q->nil;
+  int x = q->root;
+  int is_leftmost = 1;
+  while (x != q->nil) {
+    y = x;
+    if (vruntime < q->vruntime[x]) {
+      x = q->left[x];
+    } else {
+      x = q->right[x];
+      is_leftmost = 0;
+    }
+  }
+
+  q->parent[proc_id] = y;
+  if (y == q->nil) {
+    q->root = proc_id;
+  } else if (vruntime < q->vruntime[y]) {
+    q->left[y] = proc_id;
+  } else {
+    q->right[y] = proc_id;
+  }
+  q->left[proc_id] = q->nil;
+  q->right[proc_id] = q->nil;
+  q->is_red[proc_id] = 1;
+  insert_fixup(q, proc_id);
+
+  if (is_leftmost) {
+    q->leftmost = proc_id;
+  }
+  q->num_running++;
+  q->load_weight += weight;
+  return vruntime;
+}
+
+/**
+ * Removes the process with the smallest virtual runtime
+ * and records how long it waited.
+ *
+ * @param q The run queue
+ * @param now Current simulated time
+ * @param wait Where to store how long the process waited (in nanoseconds)
+ * @return The process ID. -1 if the run queue is empty.
+ */
+int cfs_dequeue(struct cfs_rq* q, uint64_t now, uint64_t* wait) {
+  int proc_id = q->leftmost;
+  if (proc_id == q->nil) {
+    return -1;
+  }
+
+  q->leftmost = get_successor(q, proc_id);
+  erase(q, proc_id);
+  q->num_running--;
+  q->load_weight -= q->weight[proc_id];
+  if (q->vruntime[proc_id] > q->min_vruntime) {
+    q->min_vruntime = q->vruntime[proc_id];
+  }
+
+  *wait = subtract_times(now, q->enqueued_at[proc_id]);
+  return proc_id;
+}
+
+/**
+ * Calculates the slice of a process that was just dequeued:
+ * its weighted share of CFS_LATENCY among everything runnable.
+ *
+ * @param q The run queue the process came from
+ * @param weight The process's weight
+ * @return The time slice (in nanoseconds)
+ */
+unsigned int cfs_get_timeslice(struct cfs_rq* q, unsigned int weight) {
+  uint64_t slice = (uint64_t) CFS_LATENCY * weight / (q->load_weight + weight);
+  return slice < CFS_MIN_GRANULARITY ? CFS_MIN_GRANULARITY : slice;
+}
+
+/**
+ * Charges a burst to a process's virtual runtime. Heavier processes
+ * are charged less, so they get more of the CPU.
+ *
+ * @return The new virtual runtime (in nanoseconds)
+ */
+uint64_t cfs_get_next_vruntime(uint64_t vruntime, unsigned int last_burst_time,
+                               unsigned int weight) {
+  return vruntime + (uint64_t) last_burst_time * NICE_0_WEIGHT / weight;
+}
+
+static void* allocate(size_t size) {
+  void* ptr = malloc(size);
+  if (ptr == NULL) {
+    perror("Failed to allocate CFS run queue");
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+/*
+ * Red-black tree operations, after Cormen et al.,
+ * Introduction to Algorithms, chapter 13.
+ * -----------------------------------------------*/
+
+static void rotate_left(struct cfs_rq* q, int x) {
+  int y = q->right[x];
+  q->right[x] = q->left[y];
+  if (q->left[y] != q->nil) {
+    q->parent[q->left[y]] = x;
+  }
+  q->parent[y] = q->parent[x];
+  if (q->parent[x] == q->nil) {
+    q->root = y;
+  } else if (x == q->left[q->parent[x]]) {
+    q->left[q->parent[x]] = y;
+  } else {
+    q->right[q->parent[x]] = y;
+  }
+  q->left[y] = x;
+  q->parent[x] = y;
+}
+
+static void rotate_right(struct cfs_rq* q, int x) {
+  int y = q->left[x];
+  q->left[x] = q->right[y];
+  if (q->right[y] != q->nil) {
+    q->parent[q->right[y]] = x;
+  }
+  q->parent[y] = q->parent[x];
+  if (q->parent[x] == q->nil) {
+    q->root = y;
+  } else if (x == q->right[q->parent[x]]) {
+    q->right[q->parent[x]] = y;
+  } else {
+    q->left[q->parent[x]] = y;
+  }
+  q->right[y] = x;
+  q->parent[x] = y;
+}
+
+static void insert_fixup(struct cfs_rq* q, int z) {
+  while (q->is_red[q->parent[z]]) {
+    int p = q->parent[z];
+    int g = q->parent[p];
+    if (p == q->left[g]) {
+      int uncle = q->right[g];
+      if (q->is_red[uncle]) {
+        q->is_red[p] = 0;
+        q->is_red[uncle] = 0;
+        q->is_red[g] = 1;
+        z = g;
+      } else {
+        if (z == q->right[p]) {
+          z = p;
+          rotate_left(q, z);
+          p = q->parent[z];
+        }
+        q->is_red[p] = 0;
+        q->is_red[g] = 1;
+        rotate_right(q, g);
+      }
+    } else {
+      int uncle = q->left[g];
+      if (q->is_red[uncle]) {
+        q->is_red[p] = 0;
+        q->is_red[uncle] = 0;
+        q->is_red[g] = 1;
+        z = g;
+      } else {
+        if (z == q->left[p]) {
+          z = p;
+          rotate_right(q, z);
+          p = q->parent[z];
+        }
+        q->is_red[p] = 0;
+        q->is_red[g] = 1;
+        rotate_left(q, g);
+      }
+    }
+  }
+  q->is_red[q->root] = 0;
+}
+
+static void transplant(struct cfs_rq* q, int u, int v) {
+  if (q->parent[u] == q->nil) {
+    q->root = v;
+  } else if (u == q->left[q->parent[u]]) {
+    q->left[q->parent[u]] = v;
+  } else {
+    q->right[q->parent[u]] = v;
+  }
+  q->parent[v] = q->parent[u]; // May set the sentinel's parent
+}
+
+static void erase(struct cfs_rq* q, int z) {
+  int y = z;
+  int x;
+  int was_red = q->is_red[y];
+  if (q->left[z] == q->nil) {
+    x = q->right[z];
+    transplant(q, z, q->right[z]);
+  } else if (q->right[z] == q->nil) {
+    x = q->left[z];
+    transplant(q, z, q->left[z]);
+  } else {
+    y = get_minimum(q, q->right[z]);
+    was_red = q->is_red[y];
+    x = q->right[y];
+    if (q->parent[y] == z) {
+      q->parent[x] = y;
+    } else {
+      transplant(q, y, q->right[y]);
+      q->right[y] = q->right[z];
+      q->parent[q->right[y]] = y;
+    }
+    transplant(q, z, y);
+    q->left[y] = q->left[z];
+    q->parent[q->left[y]] = y;
+    q->is_red[y] = q->is_red[z];
+  }
+  if (!was_red) {
+    erase_fixup(q, x);
+  }
+}
+
+static void erase_fixup(struct cfs_rq* q, int x) {
+  while (x != q->root && !q->is_red[x]) {
+    int p = q->parent[x];
+    if (x == q->left[p]) {
+      int w = q->right[p];
+      if (q->is_red[w]) {
+        q->is_red[w] = 0;
+        q->is_red[p] = 1;
+        rotate_left(q, p);
+        w = q->right[p];
+      }
+      if (!q->is_red[q->left[w]] && !q->is_red[q->right[w]]) {
+        q->is_red[w] = 1;
+        x = p;
+      } else {
+        if (!q->is_red[q->right[w]]) {
+          q->is_red[q->left[w]] = 0;
+          q->is_red[w] = 1;
+          rotate_right(q, w);
+          w = q->right[p];
+        }
+        q->is_red[w] = q->is_red[p];
+        q->is_red[p] = 0;
+        q->is_red[q->right[w]] = 0;
+        rotate_left(q, p);
+        x = q->root;
+      }
+    } else {
+      int w = q->left[p];
+      if (q->is_red[w]) {
+        q->is_red[w] = 0;
+        q->is_red[p] = 1;
+        rotate_right(q, p);
+        w = q->left[p];
+      }
+      if (!q->is_red[q->right[w]] && !q->is_red[q->left[w]]) {
+        q->is_red[w] = 1;
+        x = p;
+      } else {
+        if (!q->is_red[q->left[w]]) {
+          q->is_red[q->right[w]] = 0;
+          q->is_red[w] = 1;
+          rotate_left(q, w);
+          w = q->left[p];
+        }
+        q->is_red[w] = q->is_red[p];
+        q->is_red[p] = 0;
+        q->is_red[q->left[w]] = 0;
+        rotate_right(q, p);
+        x = q->root;
+      }
+    }
+  }
+  q->is_red[x] = 0;
+}
+
+static int get_minimum(struct cfs_rq* q, int x) {
+  while (q->left[x] != q->nil) {
+    x = q->left[x];
+  }
+  return x;
+}
+
+static int get_successor(struct cfs_rq* q, int x) {
+  if (q->right[x] != q->nil) {
+    return get_minimum(q, q->right[x]);
+  }
+  int y = q->parent[x];
+  while (y != q->nil && x == q->right[y]) {
+    x = y;
+    y = q->parent[y];
+  }
+  return y;
+}
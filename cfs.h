@@ -0,0 +1,67 @@
+#ifndef CFS_H
+#define CFS_H
+
+#include "myclock.h"
+
+/*************
+ * CONSTANTS *
+ *************/
+
+// Every runnable process should get a turn within CFS_LATENCY,
+// but no slice is shorter than CFS_MIN_GRANULARITY.
+#define CFS_LATENCY 100000000        // 100 milliseconds in nanoseconds
+#define CFS_MIN_GRANULARITY 4000000  // 4 milliseconds in nanoseconds
+
+// Weight of a process with the default share of the CPU.
+// Virtual runtime advances at real time for this weight.
+#define NICE_0_WEIGHT 1024
+
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Completely Fair Scheduler Run Queue
+ *
+ * A red-black tree of runnable processes keyed on virtual runtime.
+ * Nodes are stored in arrays indexed by process ID, so the tree never
+ * allocates. Index capacity is the black sentinel leaf. Processes
+ * with equal virtual runtimes are kept in the order they arrived.
+ * ----------------------------------------------------------------*/
+struct cfs_rq {
+  int root;
+  int leftmost;             // Process with the smallest vruntime
+  int nil;                  // Sentinel, equal to capacity
+  int num_running;          // Number of processes in the tree
+  uint64_t load_weight;     // Sum of their weights
+  uint64_t min_vruntime;    // Only increases, see cfs_enqueue()
+
+  int* left;                // Indexed by process ID
+  int* right;
+  int* parent;
+  unsigned char* is_red;
+  uint64_t* vruntime;
+  unsigned int* weight;
+  uint64_t* enqueued_at;
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_cfs_rq(struct cfs_rq* q, int num_procs);
+void free_cfs_rq(struct cfs_rq* q);
+uint64_t cfs_enqueue(struct cfs_rq* q, int proc_id, uint64_t vruntime,
+                     unsigned int weight, uint64_t now);
+int cfs_dequeue(struct cfs_rq* q, uint64_t now, uint64_t* wait);
+unsigned int cfs_get_timeslice(struct cfs_rq* q, unsigned int weight);
+uint64_t cfs_get_next_vruntime(uint64_t vruntime, unsigned int last_burst_time,
+                               unsigned int weight);
+
+#endif
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "eventq.h"
+
+#define INITIAL_CAPACITY 64
+
+static int is_before(struct event* a, struct event* b);
+static void swap_events(struct event* a, struct event* b);
+
+void init_event_queue(struct event_queue* q) {
+  q->events = malloc(sizeof(struct event) * INITIAL_CAPACITY);
+  if (q->events == NULL) {
+    perror("Failed to allocate event queue");
+    exit(EXIT_FAILURE);
+  }
+  q->size = 0;
+  q->capacity = INITIAL_CAPACITY;
+  q->next_seq = 0;
+}
+
+void free_event_queue(struct event_queue* q) {
+  free(q->events);
+  q->events = NULL;
+  q->size = 0;
+  q->capacity = 0;
+}
+
+/**
+ * Adds an event to the queue.
+ * Events with equal times come out in the order they were scheduled.
+ *
+ * @param q The event queue
+ * @param time When the event happens
+ * @param type See enum event_type
+ * @param proc_id Process the event is about, -1 if none
+ * @param generation Generation of the process's PCB slot, so events
+ *                   for a previous occupant of the slot can be ignored
+ * @return The event's sequence number, which no other event has
+ */
+unsigned long schedule_event(struct event_queue* q, uint64_t time,
+                             int type, int proc_id, unsigned int generation) {
+  if (q->size == q->capacity) {
+    q->capacity *= 2;
+    q->events = realloc(q->events, sizeof(struct event) * q->capacity);
+    if (q->events == NULL) {
+      perror("Failed to grow event queue");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  int i = q->size++;
+  q->events[i].time = time;
+  q->events[i].seq = q->next_seq++;
+  q->events[i].type = type;
+  q->events[i].proc_id = proc_id;
+  q->events[i].generation = generation;
+
+  // Sift up
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!is_before(&q->events[i], &q->events[parent])) {
+      break;
+    }
+    swap_events(&q->events[i], &q->events[parent]);
+    i = parent;
+  }
+  return q->next_seq - 1;
+}
+
+/**
+ * Removes the earliest event from the queue.
+ *
+ * @param q The event queue
+ * @param ev Where to store the event
+ * @return 1 if an event was removed and 0 if the queue is empty.
+ */
+int next_event(struct event_queue* q, struct event* ev) {
+  if (q->size == 0) {
+    return 0;
+  }
+
+  *ev = q->events[0];
+  q->events[0] = q->events[--q->size];
+
+  // Sift down
+  int i = 0;
+  while (1) {
+    int left = 2 * i + 1;
+    int right = left + 1;
+    int smallest = i;
+    if (left < q->size && is_before(&q->events[left], &q->events[smallest])) {
+      smallest = left;
+    }
+    if (right < q->size && is_before(&q->events[right], &q->events[smallest])) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      break;
+    }
+    swap_events(&q->events[i], &q->events[smallest]);
+    i = smallest;
+  }
+  return 1;
+}
+
+/**
+ * @return 1 if the earliest event happens at or before now, 0 otherwise.
+ */
+int is_event_due(struct event_queue* q, uint64_t now) {
+  return q->size > 0 && q->events[0].time <= now;
+}
+
+static int is_before(struct event* a, struct event* b) {
+  return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+static void swap_events(struct event* a, struct event* b) {
+  struct event tmp = *a;
+  *a = *b;
+  *b = tmp;
+}
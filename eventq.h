@@ -0,0 +1,57 @@
+#ifndef EVENTQ_H
+#define EVENTQ_H
+
+#include "myclock.h"
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Simulation Event Types
+ * ----------------------*/
+enum event_type {
+  EV_ARRIVAL,        // A new process should be generated
+  EV_BURST_COMPLETE, // The running process finished its burst
+  EV_PREEMPT,        // The running process was preempted
+  EV_EVENT_WAKEUP,   // A process waiting for an event is ready again
+  EV_RELEASE         // A real-time process's next job is released
+};
+
+/*
+ * Timestamped Simulation Event
+ * ----------------------------*/
+struct event {
+  uint64_t time;         // When the event happens
+  unsigned long seq;     // Insertion order, breaks ties between equal times
+  int type;              // See enum event_type
+  int proc_id;           // Process the event is about, -1 if none
+  unsigned int generation; // Generation of the process's PCB slot
+};
+
+/*
+ * Time-ordered Event Queue
+ * Binary min-heap on (time, seq).
+ * -------------------------------*/
+struct event_queue {
+  struct event* events;
+  int size;
+  int capacity;
+  unsigned long next_seq;
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_event_queue(struct event_queue* q);
+void free_event_queue(struct event_queue* q);
+unsigned long schedule_event(struct event_queue* q, uint64_t time,
+                             int type, int proc_id, unsigned int generation);
+int next_event(struct event_queue* q, struct event* ev);
+int is_event_due(struct event_queue* q, uint64_t now);
+
+#endif
@@ -0,0 +1,54 @@
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "futex.h"
+
+/**
+ * Sleep until the word is woken, as long as it
+ * still holds the expected value.
+ *
+ * The non-private futex operations are used because
+ * the word is shared between processes.
+ *
+ * @param word The futex word in shared memory
+ * @param expected_val Value the word must hold for the caller to sleep
+ * @return The return value of the futex system call
+ */
+int futex_wait(int* word, int expected_val) {
+  return syscall(SYS_futex, word, FUTEX_WAIT, expected_val, NULL, NULL, 0);
+}
+
+/**
+ * Wake processes sleeping on a futex word.
+ *
+ * @param word The futex word in shared memory
+ * @param num_waiters Maximum number of processes to wake
+ * @return Number of processes woken, or -1 on error
+ */
+int futex_wake(int* word, int num_waiters) {
+  return syscall(SYS_futex, word, FUTEX_WAKE, num_waiters, NULL, NULL, 0);
+}
+
+/**
+ * Signal the owner of a wait word.
+ * Everything written before the post is visible
+ * to the owner once it returns from wakeup_wait().
+ *
+ * @param word The wait word in shared memory
+ */
+void wakeup_post(int* word) {
+  __atomic_store_n(word, 1, __ATOMIC_RELEASE);
+  futex_wake(word, 1);
+}
+
+/**
+ * Sleep until the wait word is posted, then reset it.
+ *
+ * @param word The wait word in shared memory
+ */
+void wakeup_wait(int* word) {
+  while (__atomic_load_n(word, __ATOMIC_ACQUIRE) == 0) {
+    futex_wait(word, 0); // EAGAIN and EINTR just re-check the word
+  }
+  __atomic_store_n(word, 0, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,17 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+/**
+ * Futex-based wakeups for processes sharing memory.
+ *
+ * A wait word lives in shared memory and is 0 while its owner
+ * has nothing to do. A poster sets it to 1 and wakes the owner,
+ * which sleeps in the kernel instead of spinning.
+ */
+
+int futex_wait(int* word, int expected_val);
+int futex_wake(int* word, int num_waiters);
+void wakeup_post(int* word);
+void wakeup_wait(int* word);
+
+#endif
@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "heaprq.h"
+
+static void* allocate(size_t size);
+static int is_before(struct heap_rq* q, int a, int b);
+
+/**
+ * Initializes an empty run queue.
+ *
+ * @param q The run queue
+ * @param num_procs Number of process IDs the run queue can hold
+ */
+void init_heap_rq(struct heap_rq* q, int num_procs) {
+  q->heap = allocate(sizeof(int) * num_procs);
+  q->key = allocate(sizeof(uint64_t) * num_procs);
+  q->seq = allocate(sizeof(unsigned long) * num_procs);
+  q->enqueued_at = allocate(sizeof(uint64_t) * num_procs);
+  q->size = 0;
+  q->next_seq = 0;
+}
+
+void free_heap_rq(struct heap_rq* q) {
+  free(q->heap);
+  free(q->key);
+  free(q->seq);
+  free(q->enqueued_at);
+}
+
+/**
+ * Inserts a ready process.
+ *
+ * @param q The run queue
+ * @param proc_id The process, which must not already be in the heap
+ * @param key Processes with smaller keys come out first
+ * @param now Current simulated time, to measure its wait
+ */
+void heap_rq_enqueue(struct heap_rq* q, int proc_id, uint64_t key, uint64_t now) {
+  q->key[proc_id] = key;
+  q->seq[proc_id] = q->next_seq++;
+  q->enqueued_at[proc_id] = now;
+
+  // Sift up
+  int i = q->size++;
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!is_before(q, proc_id, q->heap[parent])) {
+      break;
+    }
+    q->heap[i] = q->heap[parent];
+    i = parent;
+  }
+  q->heap[i] = proc_id;
+}
+
+/**
+ * Removes the process with the smallest key
+ * and records how long it waited.
+ *
+ * @param q The run queue
+ * @param now Current simulated time
+ * @param wait Where to store how long the process waited (in nanoseconds)
+ * @return The process ID. -1 if the run queue is empty.
+ */
+int heap_rq_dequeue(struct heap_rq* q, uint64_t now, uint64_t* wait) {
+  if (q->size == 0) {
+    return -1;
+  }
+  int proc_id = q->heap[0];
+  int last = q->heap[--q->size];
+
+  // Sift the last process down from the root
+  int i = 0;
+  while (1) {
+    int child = 2 * i + 1;
+    if (child >= q->size) {
+      break;
+    }
+    if (child + 1 < q->size && is_before(q, q->heap[child + 1], q->heap[child])) {
+      child++;
+    }
+    if (!is_before(q, q->heap[child], last)) {
+      break;
+    }
+    q->heap[i] = q->heap[child];
+    i = child;
+  }
+  q->heap[i] = last;
+
+  *wait = subtract_times(now, q->enqueued_at[proc_id]);
+  return proc_id;
+}
+
+int heap_rq_is_empty(struct heap_rq* q) {
+  return q->size == 0;
+}
+
+static void* allocate(size_t size) {
+  void* ptr = malloc(size);
+  if (ptr == NULL) {
+    perror("Failed to allocate heap run queue");
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+static int is_before(struct heap_rq* q, int a, int b) {
+  if (q->key[a] != q->key[b]) {
+    return q->key[a] < q->key[b];
+  }
+  return q->seq[a] < q->seq[b];
+}
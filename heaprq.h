@@ -0,0 +1,40 @@
+#ifndef HEAPRQ_H
+#define HEAPRQ_H
+
+#include "myclock.h"
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Heap Run Queue
+ *
+ * A binary min-heap of process IDs on a 64-bit key, such as a
+ * predicted burst, a pass value or a deadline. Processes with
+ * equal keys come out in the order they were enqueued.
+ * ----------------------------------------------------------------*/
+struct heap_rq {
+  int* heap;                // Process IDs
+  int size;
+
+  uint64_t* key;            // Indexed by process ID
+  unsigned long* seq;       // Indexed by process ID, breaks ties
+  unsigned long next_seq;
+  uint64_t* enqueued_at;    // Indexed by process ID
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_heap_rq(struct heap_rq* q, int num_procs);
+void free_heap_rq(struct heap_rq* q);
+void heap_rq_enqueue(struct heap_rq* q, int proc_id, uint64_t key, uint64_t now);
+int heap_rq_dequeue(struct heap_rq* q, uint64_t now, uint64_t* wait);
+int heap_rq_is_empty(struct heap_rq* q);
+
+#endif
@@ -0,0 +1,67 @@
+#include <string.h>
+#include "hist.h"
+
+static int get_bucket(uint64_t value);
+static uint64_t get_bucket_top(int bucket);
+
+void init_histogram(struct histogram* h) {
+  memset(h, 0, sizeof(struct histogram));
+}
+
+void hist_record(struct histogram* h, uint64_t value) {
+  h->counts[get_bucket(value)]++;
+  h->total++;
+  if (value > h->max) {
+    h->max = value;
+  }
+}
+
+/**
+ * @param h The histogram
+ * @param percentile In [0, 100]
+ * @return The largest value in the bucket holding the percentile,
+ *         or 0 if nothing was recorded. Never more than the maximum.
+ */
+uint64_t hist_get_percentile(const struct histogram* h, double percentile) {
+  if (h->total == 0) {
+    return 0;
+  }
+  uint64_t rank = (uint64_t) (percentile / 100 * h->total + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  int i;
+  for (i = 0; i < HIST_NUM_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= rank) {
+      uint64_t top = get_bucket_top(i);
+      return top < h->max ? top : h->max;
+    }
+  }
+  return h->max;
+}
+
+/**
+ * Values below HIST_SUB_BUCKETS are their own bucket. Above that,
+ * the highest set bit picks the power of two, and the next
+ * HIST_SUB_BUCKET_BITS bits pick the bucket within it.
+ */
+static int get_bucket(uint64_t value) {
+  if (value < HIST_SUB_BUCKETS) {
+    return value;
+  }
+  int magnitude = 63 - __builtin_clzll(value);
+  int shift = magnitude - HIST_SUB_BUCKET_BITS;
+  int sub_bucket = (value >> shift) - HIST_SUB_BUCKETS;
+  return HIST_SUB_BUCKETS + shift * HIST_SUB_BUCKETS + sub_bucket;
+}
+
+static uint64_t get_bucket_top(int bucket) {
+  if (bucket < HIST_SUB_BUCKETS) {
+    return bucket;
+  }
+  int shift = bucket / HIST_SUB_BUCKETS - 1;
+  uint64_t sub_bucket = bucket % HIST_SUB_BUCKETS + HIST_SUB_BUCKETS;
+  return ((sub_bucket + 1) << shift) - 1;
+}
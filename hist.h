@@ -0,0 +1,48 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdint.h>
+
+/**
+ * Latency Histogram
+ *
+ * Log-linear buckets in the style of HdrHistogram: values below
+ * HIST_SUB_BUCKETS get a bucket each, and every power of two above
+ * that is split into HIST_SUB_BUCKETS equal buckets. Any 64-bit value
+ * is recorded in O(1) to within 1 / HIST_SUB_BUCKETS of itself, in a
+ * fixed amount of memory.
+ */
+
+/*************
+ * CONSTANTS *
+ *************/
+
+#define HIST_SUB_BUCKET_BITS 5
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BUCKET_BITS)
+#define HIST_NUM_BUCKETS (HIST_SUB_BUCKETS * (64 - HIST_SUB_BUCKET_BITS + 1))
+
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct histogram {
+  uint64_t counts[HIST_NUM_BUCKETS];
+  uint64_t total;           // Number of values recorded
+  uint64_t max;             // Largest value recorded, exactly
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_histogram(struct histogram* h);
+void hist_record(struct histogram* h, uint64_t value);
+uint64_t hist_get_percentile(const struct histogram* h, double percentile);
+
+#endif
@@ -0,0 +1,45 @@
+#include "logring.h"
+
+/**
+ * Appends a record to a ring. Called only by the ring's user process.
+ * If oss hasn't drained the ring and it is full, the record is dropped.
+ */
+void push_log_record(struct log_ring* ring, uint64_t time, int type,
+                     int proc_id, uint64_t arg) {
+  uint32_t head = ring->head;
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (head - tail == LOG_RING_SIZE) {
+    ring->dropped++;
+    return;
+  }
+
+  struct trace_record* rec = &ring->records[head & (LOG_RING_SIZE - 1)];
+  rec->time = time;
+  rec->type = type;
+  rec->proc_id = proc_id;
+  rec->arg = arg;
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Gets the oldest record in a ring without removing it.
+ * Called only by oss.
+ *
+ * @return The record, or NULL if the ring is empty.
+ */
+struct trace_record* peek_log_record(struct log_ring* ring) {
+  uint32_t tail = ring->tail;
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  if (tail == head) {
+    return NULL;
+  }
+  return &ring->records[tail & (LOG_RING_SIZE - 1)];
+}
+
+/**
+ * Removes the oldest record from a non-empty ring,
+ * giving its space back to the user process. Called only by oss.
+ */
+void pop_log_record(struct log_ring* ring) {
+  __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,49 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <stdint.h>
+#include "trace.h"
+
+/**
+ * User Process Log Rings
+ *
+ * Each user process appends its log messages, as trace records,
+ * to a single-producer single-consumer ring in its PCB. oss drains
+ * the rings into the log or trace, so logging from a user process
+ * costs no system calls.
+ */
+
+#define LOG_RING_SIZE 16 // Must be a power of two
+
+// Shared data written by different processes goes on separate
+// cache lines, so one process's writes don't slow another's reads
+#define CACHE_LINE_SIZE 64
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct log_ring {
+  uint32_t head;      // Next record to write, only written by the user process
+  uint32_t dropped;   // Records lost because the ring was full
+  struct trace_record records[LOG_RING_SIZE];
+
+  // Next record to read, only written by oss. On a cache line of its
+  // own, so draining the ring doesn't take the line the user process
+  // is writing records to away from it.
+  uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void push_log_record(struct log_ring* ring, uint64_t time, int type,
+                     int proc_id, uint64_t arg);
+struct trace_record* peek_log_record(struct log_ring* ring);
+void pop_log_record(struct log_ring* ring);
+
+#endif
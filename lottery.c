@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "lottery.h"
+
+static void* allocate(size_t size);
+static void add_tickets(struct lottery_rq* q, int proc_id, uint64_t delta);
+
+/**
+ * Initializes an empty run queue.
+ *
+ * @param q The run queue
+ * @param num_procs Number of process IDs the run queue can hold
+ */
+void init_lottery_rq(struct lottery_rq* q, int num_procs) {
+  q->capacity = num_procs;
+  q->tree = allocate(sizeof(uint64_t) * (num_procs + 1));
+  q->tickets = allocate(sizeof(unsigned int) * num_procs);
+  q->enqueued_at = allocate(sizeof(uint64_t) * num_procs);
+  q->total_tickets = 0;
+  q->num_ready = 0;
+
+  int i;
+  for (i = 0; i <= num_procs; i++) {
+    q->tree[i] = 0;
+  }
+  for (i = 0; i < num_procs; i++) {
+    q->tickets[i] = 0;
+  }
+  q->top_step = 1;
+  while (q->top_step * 2 <= num_procs) {
+    q->top_step *= 2;
+  }
+}
+
+void free_lottery_rq(struct lottery_rq* q) {
+  free(q->tree);
+  free(q->tickets);
+  free(q->enqueued_at);
+}
+
+/**
+ * Enters a ready process in the lottery.
+ *
+ * @param q The run queue
+ * @param proc_id The process, which must not already be in the lottery
+ * @param tickets Its tickets, at least 1
+ * @param now Current simulated time, to measure its wait
+ */
+void lottery_enqueue(struct lottery_rq* q, int proc_id, unsigned int tickets,
+                     uint64_t now) {
+  q->tickets[proc_id] = tickets;
+  q->enqueued_at[proc_id] = now;
+  q->total_tickets += tickets;
+  q->num_ready++;
+  add_tickets(q, proc_id, tickets);
+}
+
+/**
+ * Draws a winning ticket and removes the process holding it.
+ * Descends the Fenwick tree from its largest power of two,
+ * skipping every subtree whose tickets all come before the winner.
+ *
+ * @param q The run queue
+ * @param draw A random number, reduced to a ticket in [0, total_tickets)
+ * @param now Current simulated time
+ * @param wait Where to store how long the process waited (in nanoseconds)
+ * @return The process ID. -1 if the run queue is empty.
+ */
+int lottery_dequeue(struct lottery_rq* q, unsigned long draw, uint64_t now,
+                    uint64_t* wait) {
+  if (q->num_ready == 0) {
+    return -1;
+  }
+
+  uint64_t ticket = draw % q->total_tickets;
+  int pos = 0;
+  int step;
+  for (step = q->top_step; step > 0; step /= 2) {
+    if (pos + step <= q->capacity && q->tree[pos + step] <= ticket) {
+      pos += step;
+      ticket -= q->tree[pos];
+    }
+  }
+  int proc_id = pos; // Node pos + 1 holds the winner
+
+  add_tickets(q, proc_id, -(uint64_t) q->tickets[proc_id]);
+  q->total_tickets -= q->tickets[proc_id];
+  q->tickets[proc_id] = 0;
+  q->num_ready--;
+
+  *wait = subtract_times(now, q->enqueued_at[proc_id]);
+  return proc_id;
+}
+
+/**
+ * Advances a process's pass by its stride, for the
+ * fraction of a quantum it actually ran.
+ *
+ * @param pass The process's pass value
+ * @param tickets The process's tickets, at least 1
+ * @param last_burst_time How long it ran (in nanoseconds)
+ * @param quantum How long it was allowed to run (in nanoseconds)
+ * @return The new pass value
+ */
+uint64_t stride_get_next_pass(uint64_t pass, unsigned int tickets,
+                              unsigned int last_burst_time,
+                              unsigned int quantum) {
+  uint64_t stride = STRIDE1 / tickets;
+  return pass + stride * last_burst_time / quantum;
+}
+
+static void* allocate(size_t size) {
+  void* ptr = malloc(size);
+  if (ptr == NULL) {
+    perror("Failed to allocate lottery run queue");
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+/**
+ * Adds to the tickets of a process in every node covering it.
+ * Removing tickets adds their two's complement.
+ */
+static void add_tickets(struct lottery_rq* q, int proc_id, uint64_t delta) {
+  int i;
+  for (i = proc_id + 1; i <= q->capacity; i += i & -i) {
+    q->tree[i] += delta;
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef LOTTERY_H
+#define LOTTERY_H
+
+#include "myclock.h"
+
+/**
+ * Proportional-share Scheduling
+ *
+ * Every process holds tickets, and gets a share of the CPU in
+ * proportion to them. Lottery scheduling draws a random ticket for
+ * every dispatch. Stride scheduling is the deterministic version:
+ * ready processes are kept in a heap run queue, see heaprq.h, keyed
+ * on a pass value that advances by a stride inversely proportional
+ * to the process's tickets.
+ */
+
+/*************
+ * CONSTANTS *
+ *************/
+
+// Stride of a process with one ticket
+#define STRIDE1 (1 << 20)
+
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Lottery Run Queue
+ *
+ * A Fenwick tree over the tickets of ready processes, indexed by
+ * process ID, so adding a process and finding the holder of a
+ * ticket both take O(log n).
+ * ----------------------------------------------------------------*/
+struct lottery_rq {
+  int capacity;
+  int top_step;             // Highest power of two <= capacity
+  uint64_t* tree;           // 1-indexed, node i covers process IDs up to i - 1
+  unsigned int* tickets;    // Indexed by process ID, 0 if not ready
+  uint64_t total_tickets;   // Tickets of every ready process
+  int num_ready;
+  uint64_t* enqueued_at;    // Indexed by process ID
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_lottery_rq(struct lottery_rq* q, int num_procs);
+void free_lottery_rq(struct lottery_rq* q);
+void lottery_enqueue(struct lottery_rq* q, int proc_id, unsigned int tickets,
+                     uint64_t now);
+int lottery_dequeue(struct lottery_rq* q, unsigned long draw, uint64_t now,
+                    uint64_t* wait);
+uint64_t stride_get_next_pass(uint64_t pass, unsigned int tickets,
+                              unsigned int last_burst_time,
+                              unsigned int quantum);
+
+#endif
@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "mlfq.h"
+
+#define BITS_PER_WORD 64
+
+static void* allocate(size_t size);
+static void set_level_bit(struct my_mlfq* q, int level);
+static void clear_level_bit(struct my_mlfq* q, int level);
+static int get_highest_level(struct my_mlfq* q);
+
+/**
+ * Initializes a multi-level feedback queue.
+ * Each level gets half the time quantum of the level above it,
+ * starting from quantum and never going below MIN_TIMESLICE.
+ *
+ * @param q The queue to initialize
+ * @param num_levels Number of priority levels, at most MAX_NUM_LEVELS
+ * @param num_procs Number of process IDs the queue can hold
+ * @param quantum Time quantum of level 0 (in nanoseconds), like MY_TIMESLICE
+ */
+void init_mlfq(struct my_mlfq* q, int num_levels, int num_procs,
+               unsigned int quantum) {
+  int num_words = (num_levels + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  q->num_levels = num_levels;
+  q->levels = allocate(sizeof(struct ready_queue) * num_levels);
+  init_ready_links(&q->links, num_procs);
+  q->enqueued_at = allocate(sizeof(uint64_t) * num_procs);
+  q->level_bits = allocate(sizeof(unsigned long long) * num_words);
+  q->quanta = allocate(sizeof(unsigned int) * num_levels);
+  q->total_wait = allocate(sizeof(uint64_t) * num_levels);
+  q->num_waits = allocate(sizeof(unsigned long) * num_levels);
+  q->summary = 0;
+
+  int i;
+  for (i = 0; i < num_words; i++) {
+    q->level_bits[i] = 0;
+  }
+  for (i = 0; i < num_levels; i++) {
+    init_ready_queue(&q->levels[i]);
+    unsigned int level_quantum = i < 32 ? quantum >> i : 0;
+    q->quanta[i] = level_quantum < MIN_TIMESLICE ? MIN_TIMESLICE : level_quantum;
+    q->total_wait[i] = 0;
+    q->num_waits[i] = 0;
+  }
+}
+
+void free_mlfq(struct my_mlfq* q) {
+  free(q->levels);
+  free_ready_links(&q->links);
+  free(q->enqueued_at);
+  free(q->level_bits);
+  free(q->quanta);
+  free(q->total_wait);
+  free(q->num_waits);
+}
+
+/**
+ * Puts a process at the back of a level.
+ *
+ * @param q The queue
+ * @param proc_id The process to enqueue
+ * @param level Priority level to put the process in
+ * @param now Current simulated time, to measure its wait
+ */
+void mlfq_enqueue(struct my_mlfq* q, int proc_id, int level, uint64_t now) {
+  q->enqueued_at[proc_id] = now;
+  ready_queue_push(&q->levels[level], &q->links, proc_id);
+  set_level_bit(q, level);
+}
+
+/**
+ * Removes the process at the front of the highest non-empty level,
+ * and records how long it waited in that level.
+ *
+ * @param q The queue
+ * @param level Where to store the level the process came from
+ * @param now Current simulated time
+ * @param wait Where to store how long the process waited (in nanoseconds)
+ * @return The process ID. -1 if every level is empty.
+ */
+int mlfq_dequeue(struct my_mlfq* q, int* level, uint64_t now, uint64_t* wait) {
+  int highest = get_highest_level(q);
+  if (highest == -1) {
+    return -1;
+  }
+
+  int proc_id = ready_queue_pop(&q->levels[highest], &q->links);
+  *level = highest;
+  *wait = subtract_times(now, q->enqueued_at[proc_id]);
+  q->total_wait[highest] += *wait;
+  q->num_waits[highest]++;
+
+  if (q->levels[highest].length == 0) {
+    clear_level_bit(q, highest);
+  }
+  return proc_id;
+}
+
+unsigned int mlfq_get_quantum(struct my_mlfq* q, int level) {
+  return q->quanta[level];
+}
+
+/**
+ * Calculates the average wait time of processes in a level.
+ *
+ * @return The average wait (in nanoseconds). 0 if nothing waited yet.
+ */
+uint64_t mlfq_get_avg_wait(struct my_mlfq* q, int level) {
+  if (q->num_waits[level] == 0) {
+    return 0;
+  }
+  return q->total_wait[level] / q->num_waits[level];
+}
+
+/**
+ * Decides which level a process goes to after a burst.
+ *
+ * A process that waited too long is promoted so it doesn't starve.
+ * Otherwise, a process that used its entire quantum is demoted.
+ *
+ * @param q The queue
+ * @param level The level the process ran from
+ * @param last_burst_time How long it ran (in nanoseconds)
+ * @param wait How long it waited before running (in nanoseconds)
+ * @return The level the process should go to next.
+ */
+int mlfq_get_next_level(struct my_mlfq* q, int level,
+                        unsigned int last_burst_time, uint64_t wait) {
+  uint64_t factor = level == 1 ? ALPHA : BETA;
+  if (level > 0 &&
+      wait > WAIT_THRESHOLD &&
+      wait > factor * mlfq_get_avg_wait(q, level)) {
+    return level - 1;
+  }
+  if (level < q->num_levels - 1 &&
+      last_burst_time >= q->quanta[level]) {
+    return level + 1;
+  }
+  return level;
+}
+
+static void* allocate(size_t size) {
+  void* ptr = malloc(size);
+  if (ptr == NULL) {
+    perror("Failed to allocate multi-level feedback queue");
+    exit(EXIT_FAILURE);
+  }
+  return ptr;
+}
+
+static void set_level_bit(struct my_mlfq* q, int level) {
+  int word = level / BITS_PER_WORD;
+  q->level_bits[word] |= 1ULL << (level % BITS_PER_WORD);
+  q->summary |= 1ULL << word;
+}
+
+static void clear_level_bit(struct my_mlfq* q, int level) {
+  int word = level / BITS_PER_WORD;
+  q->level_bits[word] &= ~(1ULL << (level % BITS_PER_WORD));
+  if (q->level_bits[word] == 0) {
+    q->summary &= ~(1ULL << word);
+  }
+}
+
+/**
+ * Finds the highest priority non-empty level with
+ * two find-first-set operations.
+ *
+ * @return The level. -1 if every level is empty.
+ */
+static int get_highest_level(struct my_mlfq* q) {
+  if (q->summary == 0) {
+    return -1;
+  }
+  int word = __builtin_ctzll(q->summary);
+  return word * BITS_PER_WORD + __builtin_ctzll(q->level_bits[word]);
+}
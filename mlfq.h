@@ -0,0 +1,71 @@
+#ifndef MLFQ_H
+#define MLFQ_H
+
+#include "myclock.h"
+#include "readyq.h"
+
+/*************
+ * CONSTANTS *
+ *************/
+
+#define MY_TIMESLICE 100000000 // 100 milliseconds in nanoseconds
+#define MIN_TIMESLICE 1000     // 1 microsecond in nanoseconds
+
+// A process is promoted once it waits longer than WAIT_THRESHOLD
+// and longer than ALPHA (queue 1) or BETA (lower queues) times
+// the average wait of processes in its queue.
+#define ALPHA 1
+#define BETA 2
+#define WAIT_THRESHOLD 500000000ULL // 500 milliseconds in nanoseconds
+
+#define DEFAULT_NUM_LEVELS 3
+#define MAX_NUM_LEVELS 4096    // 64 bitmap words of 64 levels each
+
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Multi-level Feedback Queue
+ *
+ * Level 0 has the highest priority. A two-level bitmap of
+ * non-empty levels makes finding the highest ready level
+ * two find-first-set operations, however many levels there are.
+ * --------------------------------------------------------------*/
+struct my_mlfq {
+  int num_levels;
+  struct ready_queue* levels;
+
+  struct ready_links links;       // Intrusive links, indexed by process ID
+  uint64_t* enqueued_at;          // Indexed by process ID
+
+  unsigned long long summary;     // Bit w set when level_bits[w] != 0
+  unsigned long long* level_bits; // Bit b of word w set when level 64w+b is non-empty
+
+  unsigned int* quanta;           // Time quantum of each level (in nanoseconds)
+
+  uint64_t* total_wait;           // Sum of ready queue waits per level (in nanoseconds)
+  unsigned long* num_waits;       // Number of waits recorded per level
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_mlfq(struct my_mlfq* q, int num_levels, int num_procs,
+               unsigned int quantum);
+void free_mlfq(struct my_mlfq* q);
+void mlfq_enqueue(struct my_mlfq* q, int proc_id, int level, uint64_t now);
+int mlfq_dequeue(struct my_mlfq* q, int* level, uint64_t now, uint64_t* wait);
+unsigned int mlfq_get_quantum(struct my_mlfq* q, int level);
+uint64_t mlfq_get_avg_wait(struct my_mlfq* q, int level);
+int mlfq_get_next_level(struct my_mlfq* q, int level,
+                        unsigned int last_burst_time, uint64_t wait);
+
+#endif
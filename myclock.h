@@ -1,28 +1,60 @@
 #ifndef MYCLOCK_H
 #define MYCLOCK_H
 
-#define NANOSECS_PER_SEC 1000000000 // 1 * 10^9 nanoseconds
+#include <stdint.h>
+
+#define NANOSECS_PER_SEC 1000000000ULL // 1 * 10^9 nanoseconds
 
 /*
  * A simple simulated clock
- * ------------------------*/
+ *
+ * A single monotonic count of nanoseconds. oss is the only writer.
+ * Children load the whole 64-bit word atomically, so they can never
+ * see the seconds of one time and the nanoseconds of another.
+ * ---------------------------------------------------------------*/
+struct sim_clock {
+  uint64_t nanosecs;
+};
+
+/*
+ * Seconds and nanoseconds view of a time, for formatting only
+ * ------------------------------------------------------------*/
 struct my_clock {
   unsigned int secs;        // Amount of time in seconds
-  unsigned int nanosecs;    // Amount of time in nanoseconds
+  unsigned int nanosecs;    // Nanoseconds past the second
 };
 
-int is_past_time(struct my_clock a, struct my_clock b);
-
-struct my_clock add_nanosecs_to_clock(struct my_clock clock, int nanosecs);
-
-struct my_clock add_clocks(struct my_clock a, struct my_clock b);
-
-struct my_clock subtract_clocks(struct my_clock a, struct my_clock b);
-
-struct my_clock divide_clock(struct my_clock a, int divisor);
-
-struct my_clock get_clock_from_nanosecs(int nanosecs);
-
-struct my_clock subract_nanosecs_from_clock(struct my_clock clock, int nanosecs);
-
-#endif
\ No newline at end of file
+static inline uint64_t read_clock(const struct sim_clock* clock) {
+  return __atomic_load_n(&clock->nanosecs, __ATOMIC_ACQUIRE);
+}
+
+static inline void write_clock(struct sim_clock* clock, uint64_t time) {
+  __atomic_store_n(&clock->nanosecs, time, __ATOMIC_RELEASE);
+}
+
+static inline struct my_clock get_clock_view(uint64_t time) {
+  struct my_clock view;
+  view.secs = time / NANOSECS_PER_SEC;
+  view.nanosecs = time % NANOSECS_PER_SEC;
+  return view;
+}
+
+/**
+ * Returns true if a is past b.
+ */
+static inline int is_past_time(uint64_t a, uint64_t b) {
+  return a > b;
+}
+
+/**
+ * Returns a - b, or 0 if b is past a.
+ */
+static inline uint64_t subtract_times(uint64_t a, uint64_t b) {
+  return (a - b) & -(uint64_t) (a >= b);
+}
+
+static inline uint64_t max_time(uint64_t a, uint64_t b) {
+  return a ^ ((a ^ b) & -(uint64_t) (b > a));
+}
+
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <stdio.h>
@@ -12,107 +13,346 @@
 #include <sys/time.h>
 #include <string.h>
 #include <sys/wait.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
 #include <sys/stat.h>
 #include <ctype.h>
+#include <limits.h>
 #include <time.h>
-#include <sys/queue.h>
 #include "structs.h"
-#include "sem.h"
 #include "oss.h"
 #include "ossshm.h"
 #include "myclock.h"
+#include "futex.h"
+#include "eventq.h"
+#include "mlfq.h"
+#include "heaprq.h"
+#include "policy.h"
+#include "rng.h"
+#include "hist.h"
+#include "stats.h"
+#include "sched.h"
+#include "slots.h"
+#include "trace.h"
+#include "workload.h"
 
 /*
  * CONSTANTS
  *-----------*/
 
-// Maximum number of running processes at any given time
-#define MAX_RUNNING_PROCS 18
+// Default number of process control blocks, see -m
+#define DEFAULT_MAX_RUNNING_PROCS 18
 
-// Total number of processes to be created
-#define MAX_PROCS 3
+// Default total number of processes to be created, see -n
+#define DEFAULT_MAX_PROCS 3
+
+// Default tickets of each process class, see -T
+#define DEFAULT_INTERACTIVE_TICKETS 400
+#define DEFAULT_NORMAL_TICKETS 100
+#define DEFAULT_BATCH_TICKETS 25
+
+// Default percentage of processes that are real-time, see -r
+#define DEFAULT_REALTIME_PERCENT 0
+
+// Real-time periods are picked in [MIN_PERIOD, MAX_PERIOD)
+#define MIN_PERIOD 200000000 // 200 milliseconds in nanoseconds
+#define MAX_PERIOD NANOSECS_PER_SEC
+
+// Longest time quantum (in nanoseconds), see -Q
+#define MAX_QUANTUM 1000000000 // 1 second in nanoseconds
+
+// Default number of simulated CPUs, see -c
+#define DEFAULT_NUM_CPUS 1
+#define MAX_NUM_CPUS 1024
 
 /*
  * GLOBALS
  *-----------*/
-static unsigned int clock_seg_id;
-static struct my_clock* clock_shm;
+// Everything shared with user processes, see ossshm.h
+static struct oss_shm shm;
+static char shm_name[32];       // Empty under USER_THREAD, where nothing is shared
+static int use_huge_pages = 0;  // See -H
+
+static struct sim_clock* clock_shm;
+
+// oss is the only writer of the clock, so it keeps its own copy
+static uint64_t now;
+static uint64_t started_at;
 
-static unsigned int pcb_seg_id;
 static struct pcb* pcb_shm;
 
-static unsigned int curr_sched_seg_id;
 static struct curr_sched* curr_sched_shm;
 
-static char pcb_shm_ids[MAX_PROCS];
+static struct slot_table pcb_slots;
+static pid_t* child_pids; // Indexed by process ID, 0 when there is none
 
-static struct my_clock last_created_at;
+// Whether each process has been dispatched yet, indexed by process ID.
+// Only oss uses it, so it isn't in the shared PCBs.
+static unsigned char* has_run;
 
-int num_procs_completed = 0;
-int num_procs_generated = 0;
-static int sem_id;
+// See enum user_mode
+static int user_mode = USER_POOL;
+static struct user_proc* user_procs; // Indexed by process ID, under USER_THREAD
 
-FILE* fp;
+// Arguments of user, see spawn_user()
+static char seed_string[21];
 
-TAILQ_HEAD(q1head, entry) high_prio_queue =
-    TAILQ_HEAD_INITIALIZER(high_prio_queue);
+static int max_running_procs = DEFAULT_MAX_RUNNING_PROCS;
+static long max_procs = DEFAULT_MAX_PROCS;
 
-struct q1head *q1headp;
+static struct event_queue events;
+static unsigned long num_events = 0; // Events handled, not counting stale ones
 
-struct entry {
-  pid_t pid;
-  TAILQ_ENTRY(entry) entries;
-};
+long num_procs_completed = 0;
+long num_procs_generated = 0;
+
+// Updated as each process terminates, so they're right at any time
+// during a run, see print_progress() (in nanoseconds)
+static struct running_stats turnaround_stats;
+static struct running_stats wait_stats;       // Time in the system not spent running
+static struct running_stats cpu_share_stats;  // For Jain's fairness index
+static unsigned long num_log_records_dropped = 0;
+
+// Distributions for the report, see print_percentiles()
+static struct histogram turnaround_hist;  // Per terminated process
+static struct histogram response_hist;    // Creation to first dispatch, per process
+static struct histogram burst_hist;       // Per burst
 
+// Waits in every ready queue, in the real-time queue and in each
+// queue of the policy. Policies without levels have one queue.
+static struct queue_waits all_waits;
+static struct queue_waits realtime_waits;
+static struct queue_waits** queue_waits;  // Allocated when first used
+static int num_queues;
 
-TAILQ_HEAD(q2head, entry) med_prio_queue =
-    TAILQ_HEAD_INITIALIZER(med_prio_queue);
+static volatile sig_atomic_t is_progress_requested = 0;
 
-struct q2head *q2headp;
+FILE* fp;
+
+static struct cpu* cpus;
+static int num_cpus = DEFAULT_NUM_CPUS;
+static int policy = POLICY_MLFQ;
+static unsigned int quantum = MY_TIMESLICE;
+static const struct sched_ops* sched; // The policy's operations, see sched.h
 
-TAILQ_HEAD(q3head, entry) low_prio_queue =
-    TAILQ_HEAD_INITIALIZER(low_prio_queue);
+static const char* class_names[NUM_PROC_CLASSES] = {
+  [CLASS_INTERACTIVE] = "interactive",
+  [CLASS_NORMAL] = "normal",
+  [CLASS_BATCH] = "batch"
+};
+static unsigned int class_tickets[NUM_PROC_CLASSES] = {
+  [CLASS_INTERACTIVE] = DEFAULT_INTERACTIVE_TICKETS,
+  [CLASS_NORMAL] = DEFAULT_NORMAL_TICKETS,
+  [CLASS_BATCH] = DEFAULT_BATCH_TICKETS
+};
 
-struct q3head *q3headp;
+// CPU share of terminated processes of each class
+static struct running_stats class_cpu_share_stats[NUM_PROC_CLASSES];
+static int num_queued = 0; // Ready processes over every CPU
+static int realtime_percent = DEFAULT_REALTIME_PERCENT;
 
-void print_queues() {
-  struct entry* np;
-  fprintf(fp, "[OSS] Queue 1: [ ");
-  TAILQ_FOREACH_REVERSE(np, &high_prio_queue, q1head, entries)
-      fprintf(fp, "%d ", np->pid);
+// Real-time jobs and how late they finished, see end_job()
+#define NUM_LATENESS_BUCKETS 6
+static const char* lateness_bucket_names[NUM_LATENESS_BUCKETS] = {
+  "on time", "up to 1ms", "up to 10ms", "up to 100ms", "up to 1s", "over 1s"
+};
+static unsigned long lateness_buckets[NUM_LATENESS_BUCKETS];
+static unsigned long num_missed_deadlines = 0;
+static struct running_stats lateness_stats; // Per job, negative if early
 
-  fprintf(fp, "]\n");
+static int* dispatched_pids;  // Processes dispatched together, see run_ready_processes()
+static int* dispatched_cpus;
 
-  fprintf(fp, "[OSS] Queue 2: [ ");
-  TAILQ_FOREACH_REVERSE(np, &med_prio_queue, q2head, entries)
-      fprintf(fp, "%d ", np->pid);
+// Every random draw of oss comes from this stream, see -s
+static uint64_t seed;
+static struct rng rng;
 
-  fprintf(fp, "]\n");
+static struct trace trace;
+static int is_tracing = 0;
+static int is_text_logging = 1;
 
-  fprintf(fp, "[OSS] Queue 3: [ ");
-  TAILQ_FOREACH_REVERSE(np, &low_prio_queue, q3head, entries)
-      fprintf(fp, "%d ", np->pid);
+// The workload replayed under -w, see workload.h
+static struct workload workload;
+static int is_replaying = 0;
+static const struct workload_proc* arriving; // The next to arrive, or NULL
+static struct workload_cursor* cursors;      // Indexed by process ID
+static int is_arrival_deferred = 0;          // The process table was full when it arrived
 
-  fprintf(fp, "]\n");
+/**
+ * Records something oss did, in the binary trace and/or the text log.
+ *
+ * @param type See enum trace_type
+ * @param proc_id The process it happened to
+ * @param arg Details, see enum trace_type
+ */
+static void log_event(int type, int proc_id, uint64_t arg) {
+  if (is_tracing) {
+    write_trace(&trace, now, type, proc_id, arg);
+  }
+  if (is_text_logging) {
+    struct trace_record rec = { now, type, proc_id, arg };
+    print_trace_record(fp, &rec, num_cpus);
+  }
 }
 
-static void free_queue();
+/**
+ * Writes a record logged by a user process to the binary trace
+ * and/or the text log, keeping the time the process logged it at.
+ */
+static void log_user_record(struct trace_record* rec) {
+  if (is_tracing) {
+    write_trace(&trace, rec->time, rec->type, rec->proc_id, rec->arg);
+  }
+  if (is_text_logging) {
+    print_trace_record(fp, rec, num_cpus);
+  }
+}
+
+/**
+ * Empties the log rings of some user processes, merging
+ * their records in simulated-time order. Each ring is
+ * already in time order, so the oldest record at the
+ * front of any ring is the next one to write.
+ *
+ * @param proc_ids The processes whose rings to drain
+ * @param num_procs The number of processes
+ */
+static void drain_log_rings(const int* proc_ids, int num_procs) {
+  while (1) {
+    struct log_ring* oldest_ring = NULL;
+    struct trace_record* oldest = NULL;
+    int i;
+    for (i = 0; i < num_procs; i++) {
+      struct log_ring* ring = &pcb_shm[proc_ids[i]].log;
+      struct trace_record* rec = peek_log_record(ring);
+      if (rec != NULL && (oldest == NULL || rec->time < oldest->time)) {
+        oldest_ring = ring;
+        oldest = rec;
+      }
+    }
+    if (oldest == NULL) {
+      return;
+    }
+    log_user_record(oldest);
+    pop_log_record(oldest_ring);
+  }
+}
+
+static void print_queues(int cpu) {
+  if (is_text_logging && policy_has_levels(policy)) {
+    struct my_mlfq* mlfq = &cpus[cpu].mlfq;
+    print_ready_queues(fp, cpu, num_cpus, mlfq->levels, mlfq->num_levels,
+                       &mlfq->links);
+  }
+}
 
 int main(int argc, char* argv[]) {
   int help_flag = 0;
   char* log_file = "oss.out";
+  char* trace_file = NULL;
+  char* workload_file = NULL;
+  int has_log_file = 0;
+  int num_levels = DEFAULT_NUM_LEVELS;
+  int has_seed = 0;
+  int has_max_procs = 0;
+  char* end;
   opterr = 0;
   int c;
 
-  while ((c = getopt(argc, argv, "hl:")) != -1) {
+  while ((c = getopt(argc, argv, "hHl:q:n:m:t:c:p:T:r:s:Q:u:w:")) != -1) {
     switch (c) {
       case 'h':
         help_flag = 1;
         break;
+      case 'H':
+        use_huge_pages = 1;
+        break;
       case 'l':
         log_file = optarg;
+        has_log_file = 1;
+        break;
+      case 't':
+        trace_file = optarg;
+        break;
+      case 'q':
+        num_levels = atoi(optarg);
+        if (num_levels < 1 || num_levels > MAX_NUM_LEVELS) {
+          fprintf(stderr, "Number of queues must be in [1, %d].\n", MAX_NUM_LEVELS);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'n':
+        max_procs = atol(optarg);
+        if (max_procs < 1) {
+          fprintf(stderr, "Total number of processes must be positive.\n");
+          return EXIT_FAILURE;
+        }
+        has_max_procs = 1;
+        break;
+      case 'm':
+        max_running_procs = atoi(optarg);
+        if (max_running_procs < 1) {
+          fprintf(stderr, "Number of process control blocks must be positive.\n");
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'c':
+        num_cpus = atoi(optarg);
+        if (num_cpus < 1 || num_cpus > MAX_NUM_CPUS) {
+          fprintf(stderr, "Number of CPUs must be in [1, %d].\n", MAX_NUM_CPUS);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'p':
+        policy = get_policy_by_name(optarg);
+        if (policy == -1) {
+          fprintf(stderr, "Unknown scheduling policy `%s'.\n", optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'T':
+        if (parse_class_tickets(optarg) == -1) {
+          fprintf(stderr, "Tickets must be three positive numbers, like `%d,%d,%d'.\n",
+                  DEFAULT_INTERACTIVE_TICKETS, DEFAULT_NORMAL_TICKETS,
+                  DEFAULT_BATCH_TICKETS);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'r':
+        realtime_percent = atoi(optarg);
+        if (realtime_percent < 0 || realtime_percent > 100) {
+          fprintf(stderr, "Percentage of real-time processes must be in [0, 100].\n");
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'Q':
+        quantum = atoi(optarg);
+        if (quantum < MIN_TIMESLICE || quantum > MAX_QUANTUM) {
+          fprintf(stderr, "Time quantum must be in [%d, %d] nanoseconds.\n",
+                  MIN_TIMESLICE, MAX_QUANTUM);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'u':
+        if (strcmp(optarg, "pool") == 0) {
+          user_mode = USER_POOL;
+        } else if (strcmp(optarg, "spawn") == 0) {
+          user_mode = USER_SPAWN;
+        } else if (strcmp(optarg, "thread") == 0) {
+          user_mode = USER_THREAD;
+        } else {
+          fprintf(stderr, "User processes must be run by `pool', `spawn' or `thread'.\n");
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'w':
+        workload_file = optarg;
+        break;
+      case 's':
+        seed = strtoull(optarg, &end, 10);
+        if (*optarg == '\0' || *end != '\0') {
+          fprintf(stderr, "Seed must be a non-negative number.\n");
+          return EXIT_FAILURE;
+        }
+        has_seed = 1;
         break;
       case '?':
         if (is_required_argument(optopt)) {
@@ -145,109 +385,197 @@ int main(int argc, char* argv[]) {
     exit(EXIT_FAILURE);
   }
 
-  srand(time(NULL));
-
-  int k;
-  for (k = 0; k < MAX_PROCS; k++) {
-    pcb_shm_ids[k] = 0;
+  if (!has_seed) {
+    seed = time(NULL);
+  }
+  rng_seed(&rng, seed, RNG_STREAM_OSS);
+  sched = get_sched_ops(policy);
+
+  if (workload_file != NULL) {
+    open_workload(&workload, workload_file);
+    if (workload.header->num_procs == 0) {
+      fprintf(stderr, "Workload %s has no processes.\n", workload_file);
+      return EXIT_FAILURE;
+    }
+    // Replays the whole workload unless -n asks for fewer processes
+    if (!has_max_procs || max_procs > workload.header->num_procs) {
+      max_procs = workload.header->num_procs;
+    }
+    cursors = calloc(max_running_procs, sizeof(struct workload_cursor));
+    if (cursors == NULL) {
+      perror("Failed to allocate workload cursors");
+      exit(EXIT_FAILURE);
+    }
+    is_replaying = 1;
   }
 
-  TAILQ_INIT(&high_prio_queue);
-  TAILQ_INIT(&med_prio_queue);
-  TAILQ_INIT(&low_prio_queue);
-
-  FILE* fp;
-  fp = fopen(log_file, "w+");
-
-  if (fp == NULL) {
-    perror("Failed to open log file");
+  init_slot_table(&pcb_slots, max_running_procs);
+  child_pids = calloc(max_running_procs, sizeof(pid_t));
+  has_run = malloc(max_running_procs);
+  if (child_pids == NULL || has_run == NULL) {
+    perror("Failed to allocate child process IDs");
     exit(EXIT_FAILURE);
   }
 
-  signal(SIGINT, free_shm_and_abort);
+  cpus = malloc(sizeof(struct cpu) * num_cpus);
+  if (cpus == NULL) {
+    perror("Failed to allocate CPUs");
+    exit(EXIT_FAILURE);
+  }
+  int i;
+  for (i = 0; i < num_cpus; i++) {
+    memset(&cpus[i], 0, sizeof(struct cpu));
+    cpus[i].quantum = quantum;
+    sched->init(&cpus[i], num_levels, max_running_procs);
+    rng_seed(&cpus[i].rng, seed, RNG_STREAM_CPU(i));
+    init_heap_rq(&cpus[i].edf, max_running_procs);
+    cpus[i].running_proc_id = -1;
+  }
+  init_running_stats(&turnaround_stats);
+  init_running_stats(&wait_stats);
+  init_running_stats(&cpu_share_stats);
+  init_running_stats(&lateness_stats);
+  for (i = 0; i < NUM_PROC_CLASSES; i++) {
+    init_running_stats(&class_cpu_share_stats[i]);
+  }
+  init_histogram(&turnaround_hist);
+  init_histogram(&response_hist);
+  init_histogram(&burst_hist);
+  init_running_stats(&all_waits.stats);
+  init_histogram(&all_waits.hist);
+  init_running_stats(&realtime_waits.stats);
+  init_histogram(&realtime_waits.hist);
+  num_queues = policy_has_levels(policy) ? cpus[0].mlfq.num_levels : 1;
+  queue_waits = calloc(num_queues, sizeof(struct queue_waits*));
+  if (queue_waits == NULL) {
+    perror("Failed to allocate queue waits");
+    exit(EXIT_FAILURE);
+  }
 
-  sem_id = allocate_sem(IPC_PRIVATE, IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
+  dispatched_pids = malloc(sizeof(int) * num_cpus);
+  dispatched_cpus = malloc(sizeof(int) * num_cpus);
+  if (dispatched_pids == NULL || dispatched_cpus == NULL) {
+    perror("Failed to allocate dispatched processes");
+    exit(EXIT_FAILURE);
+  }
 
-  int init_sem_success = init_sem(sem_id, 0);
-  if (init_sem_success == -1) {
-    perror("Faled to initilaize binary semaphore");
-    return EXIT_FAILURE;
+  // With a trace, text logging is only done when asked for with -l
+  if (trace_file != NULL) {
+    // FIFO has a single level, whatever -q says
+    if (policy_has_levels(policy)) {
+      num_levels = cpus[0].mlfq.num_levels;
+    }
+    open_trace(&trace, trace_file, num_levels, max_running_procs, num_cpus,
+               policy);
+    is_tracing = 1;
+    is_text_logging = has_log_file;
   }
 
-  clock_seg_id = get_clock_shm();
-  clock_shm = attach_to_clock_shm(clock_seg_id);
+  // The shared memory object outlives oss unless it's removed,
+  // so it's removed however oss is told to stop
+  signal(SIGINT, free_shm_and_abort);
+  signal(SIGTERM, free_shm_and_abort);
+  signal(SIGHUP, free_shm_and_abort);
+  signal(SIGUSR1, request_progress);
+
+  if (user_mode == USER_THREAD) {
+    // Nothing outside oss reads the arena, so it needn't be shared
+    create_oss_shm(&shm, NULL, max_running_procs, num_cpus, use_huge_pages);
+    user_procs = malloc(sizeof(struct user_proc) * max_running_procs);
+    if (user_procs == NULL) {
+      perror("Failed to allocate simulated processes");
+      exit(EXIT_FAILURE);
+    }
+  } else {
+    sprintf(shm_name, "/oss.%d", getpid());
+    create_oss_shm(&shm, shm_name, max_running_procs, num_cpus, use_huge_pages);
+  }
+  clock_shm = shm.clock;
+  pcb_shm = shm.pcbs;
+  curr_sched_shm = shm.curr_sched;
 
   // Initialize clock to 1 second to simulate overhead
-  clock_shm->secs = 1;
+  set_clock(NANOSECS_PER_SEC);
+  started_at = now;
 
-  pcb_seg_id = get_pcb_shm(MAX_PROCS);
-  pcb_shm = attach_to_pcb_shm(pcb_seg_id);
+  for (i = 0; i < num_cpus; i++) {
+    // Initialize to a value that won't be equal to a process ID
+    curr_sched_shm[i].proc_id = -10;
+    curr_sched_shm[i].is_replay = is_replaying;
+  }
+
+  sprintf(seed_string, "%llu", (unsigned long long) seed);
+  if (user_mode == USER_POOL) {
+    // Started once, waiting to be given a process, see create_process()
+    for (i = 0; i < max_running_procs; i++) {
+      child_pids[i] = spawn_user(i, 1);
+    }
+  }
 
-  curr_sched_seg_id = get_curr_sched_shm();
-  curr_sched_shm = attach_to_curr_sched_shm(curr_sched_seg_id);
-  // Initialize to a value that won't be equal to a process ID
-  curr_sched_shm->proc_id = -10;
+  init_event_queue(&events);
+  if (is_replaying) {
+    arriving = next_workload_proc(&workload);
+    schedule_event(&events, started_at + arriving->arrival, EV_ARRIVAL, -1, 0);
+  } else {
+    schedule_event(&events, now, EV_ARRIVAL, -1, 0);
+  }
 
-  fork_and_exec_child(0);
+  /*
+   * Discrete-event loop: the clock jumps straight to the next
+   * event, so the work done scales with the number of
+   * scheduling decisions rather than with simulated time.
+   */
+  while (num_procs_completed < max_procs) {
+    if (is_progress_requested) {
+      is_progress_requested = 0;
+      print_progress();
+    }
 
-  struct my_clock create_at;
-  create_at.secs = (rand() % 3) + clock_shm->secs;
-  create_at.nanosecs = clock_shm->nanosecs;
-  while (1) {
-    if (clock_shm->nanosecs >= NANOSECS_PER_SEC) {
-      clock_shm->secs += 1;
-      clock_shm->nanosecs -= NANOSECS_PER_SEC;
+    // Events that are already due go first, so every process
+    // ready at this time can be dispatched together
+    if (!is_event_due(&events, now) && run_ready_processes() > 0) {
+      continue;
     }
 
-    int proc_id = get_proc_id();  // -1 if process table is full
-    if (num_procs_completed >= MAX_PROCS && is_queue_empty()) {
+    struct event ev;
+    if (!next_event(&events, &ev)) {
       break;
-    } else if (is_past_last_created(create_at) && proc_id != -1 && num_procs_generated < MAX_PROCS) {
-      fork_and_exec_child(proc_id);
-      last_created_at.secs = clock_shm->secs;
-      last_created_at.nanosecs = clock_shm->nanosecs;
-      create_at.secs = (rand() % 3) + clock_shm->secs;
-      create_at.nanosecs = clock_shm->nanosecs;
-      clock_shm->nanosecs += 2;
-      continue;
-    } else if (!is_queue_empty()) {
-        int scheduled_pid = dispatch_process();
-        clock_shm->nanosecs += rand() % 1001; // Scheduling Overhead
-        sem_wait(sem_id);
-        fprintf(
-          fp,
-          "[OSS] [%02d:%010d] Process %d ran for %d nanoseconds during last burst.\n",
-          clock_shm->secs,
-          clock_shm->nanosecs,
-          scheduled_pid,
-          pcb_shm[scheduled_pid].last_burst_time
-        );
-        clock_shm->nanosecs += pcb_shm[scheduled_pid].last_burst_time;
-        if (!pcb_shm[scheduled_pid].ready_to_terminate) {
-          fprintf(
-            fp,
-            "[OSS] [%02d:%010d] Putting process %d in queue %d.\n",
-            clock_shm->secs,
-            clock_shm->nanosecs,
-            scheduled_pid,
-            0
-          );
-          enqueue_process(scheduled_pid, 0);
-        } else {
-          num_procs_completed++;
-          fprintf(
-            fp,
-            "[OSS] [%02d:%010d] Process %d terminated. Number of processes completed %d\n",
-            clock_shm->secs,
-            clock_shm->nanosecs,
-            scheduled_pid,
-            num_procs_completed
-          );
-        }
-        // pcb_shm_ids[scheduled_pid] = 0;
-    } else {
-      clock_shm->nanosecs += rand() % 1001;
     }
+    if (ev.proc_id != -1 &&
+        ev.generation != pcb_shm[ev.proc_id].generation) {
+      continue; // The slot was recycled since the event was scheduled
+    }
+    if ((ev.type == EV_BURST_COMPLETE || ev.type == EV_PREEMPT) &&
+        ev.seq != cpus[pcb_shm[ev.proc_id].cpu].burst_event_seq) {
+      continue; // The burst was cut short, see preempt_if_needed()
+    }
+    set_clock(max_time(ev.time, now));
+    num_events++;
+
+    switch (ev.type) {
+      case EV_ARRIVAL:
+        generate_process();
+        break;
+      case EV_BURST_COMPLETE:
+      case EV_PREEMPT:
+        cpus[pcb_shm[ev.proc_id].cpu].running_proc_id = -1;
+        end_burst(ev.proc_id);
+        break;
+      case EV_EVENT_WAKEUP:
+        log_event(TR_EVENT_WAKEUP, ev.proc_id, get_queue(ev.proc_id));
+        enqueue_process(ev.proc_id, pcb_shm[ev.proc_id].priority);
+        preempt_if_needed(ev.proc_id);
+        break;
+      case EV_RELEASE:
+        log_event(TR_RELEASE, ev.proc_id, pcb_shm[ev.proc_id].deadline);
+        enqueue_process(ev.proc_id, pcb_shm[ev.proc_id].priority);
+        preempt_if_needed(ev.proc_id);
+        break;
+    }
+  }
+
+  if (user_mode == USER_POOL) {
+    retire_workers();
   }
 
   // Wait for any remaining children to terminate
@@ -261,7 +589,29 @@ int main(int argc, char* argv[]) {
   print_report();
 
   free_shm();
-  free_queue();
+  free_slot_table(&pcb_slots);
+  free(child_pids);
+  free(has_run);
+  free(user_procs);
+  free(cursors);
+  for (i = 0; i < num_cpus; i++) {
+    sched->teardown(&cpus[i]);
+    free_heap_rq(&cpus[i].edf);
+  }
+  for (i = 0; i < num_queues; i++) {
+    free(queue_waits[i]);
+  }
+  free(queue_waits);
+  free(cpus);
+  free(dispatched_pids);
+  free(dispatched_cpus);
+  free_event_queue(&events);
+  if (is_tracing) {
+    close_trace(&trace);
+  }
+  if (is_replaying) {
+    close_workload(&workload);
+  }
   fclose(fp);
 
   return EXIT_SUCCESS;
@@ -271,19 +621,12 @@ int main(int argc, char* argv[]) {
  * Frees all allocated shared memory
  */
 static void free_shm(void) {
-  detach_from_clock_shm(clock_shm);
-  shmctl(clock_seg_id, IPC_RMID, 0);
-
-  detach_from_pcb_shm(pcb_shm);
-  shmctl(pcb_seg_id, IPC_RMID, 0);
-
-  detach_from_curr_sched_shm(curr_sched_shm);
-  shmctl(curr_sched_seg_id, IPC_RMID, 0);
-
-  int deallocate_sem_success = deallocate_sem(sem_id);
-  if (deallocate_sem_success == -1) {
-    perror("Failed to deallocate binary semaphore");
-    exit(EXIT_FAILURE);
+  if (shm.header == NULL) {
+    return; // Not created yet
+  }
+  detach_from_oss_shm(&shm);
+  if (shm_name[0] != '\0') {
+    remove_oss_shm(shm_name);
   }
 }
 
@@ -296,6 +639,15 @@ static void free_shm_and_abort(int s) {
 }
 
 
+/**
+ * Asks the main loop for a progress line, see print_progress().
+ * Only sets a flag, since stdio isn't async-signal-safe.
+ */
+static void request_progress(int s) {
+  is_progress_requested = 1;
+}
+
+
 /**
  * Set up the interrupt handler.
  */
@@ -319,7 +671,35 @@ static void print_help_message(char* executable_name,
   printf("Usage: ./%s\n\n", executable_name);
   printf("Arguments:\n");
   printf(" -h  Show help.\n");
+  printf(" -H  Ask for huge pages for the shared memory, which saves TLB misses\n");
+  printf("     with many process control blocks.\n");
   printf(" -l  Specify the log file. Defaults to '%s'.\n", log_file);
+  printf(" -q  Specify the number of queues. Defaults to %d.\n", DEFAULT_NUM_LEVELS);
+  printf(" -n  Specify the total number of processes. Defaults to %d.\n", DEFAULT_MAX_PROCS);
+  printf(" -m  Specify the number of process control blocks. Defaults to %d.\n", DEFAULT_MAX_RUNNING_PROCS);
+  printf(" -t  Write a binary trace to this file, see ossdump.\n");
+  printf("     Events then only go in the log file when -l is given.\n");
+  printf(" -Q  Specify the time quantum of the top queue in nanoseconds.\n");
+  printf("     Lower queues get half the quantum of the one above. Defaults to %d.\n",
+         MY_TIMESLICE);
+  printf(" -c  Specify the number of simulated CPUs. Defaults to %d.\n", DEFAULT_NUM_CPUS);
+  printf(" -p  Specify the scheduling policy, mlfq, fifo, cfs, srtf, lottery\n");
+  printf("     or stride.\n");
+  printf("     Defaults to mlfq.\n");
+  printf(" -r  Specify the percentage of processes that are real-time,\n");
+  printf("     scheduled earliest deadline first. Defaults to %d.\n", DEFAULT_REALTIME_PERCENT);
+  printf(" -s  Specify the seed of every random draw, so a run can be repeated\n");
+  printf("     exactly. Defaults to the current time.\n");
+  printf(" -T  Specify the tickets of interactive, normal and batch processes\n");
+  printf("     for lottery and stride scheduling. Defaults to %d,%d,%d.\n",
+         DEFAULT_INTERACTIVE_TICKETS, DEFAULT_NORMAL_TICKETS, DEFAULT_BATCH_TICKETS);
+  printf(" -u  Specify how processes are run, pool, spawn or thread. pool starts\n");
+  printf("     one user worker per process control block up front, spawn starts\n");
+  printf("     a user process for every process generated, and thread runs them\n");
+  printf("     inside oss without user processes. Defaults to pool.\n");
+  printf(" -w  Replay a workload written by osswl instead of drawing arrivals\n");
+  printf("     and bursts at random. Every process in it is run unless -n\n");
+  printf("     is given.\n");
 }
 
 /**
@@ -331,6 +711,18 @@ static void print_help_message(char* executable_name,
 static int is_required_argument(char optopt) {
   switch (optopt) {
     case 'l':
+    case 'q':
+    case 'n':
+    case 'm':
+    case 't':
+    case 'c':
+    case 'p':
+    case 'T':
+    case 'r':
+    case 's':
+    case 'Q':
+    case 'u':
+    case 'w':
       return 1;
     default:
       return 0;
@@ -347,200 +739,688 @@ static void print_required_argument_message(char option) {
     case 'l':
       fprintf(stderr, "Option -%c requires the name of the log file.\n", optopt);
       break;
+    case 'q':
+      fprintf(stderr, "Option -%c requires the number of queues.\n", optopt);
+      break;
+    case 'n':
+      fprintf(stderr, "Option -%c requires the total number of processes.\n", optopt);
+      break;
+    case 'm':
+      fprintf(stderr, "Option -%c requires the number of process control blocks.\n", optopt);
+      break;
+    case 't':
+      fprintf(stderr, "Option -%c requires the name of the trace file.\n", optopt);
+      break;
+    case 'c':
+      fprintf(stderr, "Option -%c requires the number of CPUs.\n", optopt);
+      break;
+    case 'p':
+      fprintf(stderr, "Option -%c requires the name of the scheduling policy.\n", optopt);
+      break;
+    case 'T':
+      fprintf(stderr, "Option -%c requires the tickets of each process class.\n", optopt);
+      break;
+    case 'r':
+      fprintf(stderr, "Option -%c requires the percentage of real-time processes.\n", optopt);
+      break;
+    case 's':
+      fprintf(stderr, "Option -%c requires the seed.\n", optopt);
+      break;
+    case 'Q':
+      fprintf(stderr, "Option -%c requires the time quantum.\n", optopt);
+      break;
+    case 'u':
+      fprintf(stderr, "Option -%c requires how to run processes.\n", optopt);
+      break;
+    case 'w':
+      fprintf(stderr, "Option -%c requires the name of the workload file.\n", optopt);
+      break;
   }
 }
 
+/**
+ * Sets the tickets of each process class from a comma-separated
+ * list, in the order of enum proc_class.
+ *
+ * @param tickets The list, like "400,100,25"
+ * @return 0 on success and -1 if the list is invalid.
+ */
+static int parse_class_tickets(char* tickets) {
+  unsigned int parsed[NUM_PROC_CLASSES];
+  char* token = strtok(tickets, ",");
+  int i;
+  for (i = 0; i < NUM_PROC_CLASSES; i++) {
+    if (token == NULL || atoi(token) < 1) {
+      return -1;
+    }
+    parsed[i] = atoi(token);
+    token = strtok(NULL, ",");
+  }
+  if (token != NULL) {
+    return -1;
+  }
+  memcpy(class_tickets, parsed, sizeof(parsed));
+  return 0;
+}
 
-static void fork_and_exec_child(int proc_id) {
-  pcb_shm_ids[proc_id] = 1;
+
+/**
+ * Sets up a new process in a free PCB slot and puts it in a
+ * ready queue, then hands the slot to its worker or spawns
+ * a user process for it.
+ *
+ * @param proc_id The free slot
+ */
+static void create_process(int proc_id) {
   num_procs_generated++;
 
+  // Recycle the slot: clear the last occupant's PCB and bump the generation
+  unsigned int generation = pcb_shm[proc_id].generation + 1;
+  memset(&pcb_shm[proc_id], 0, sizeof(struct pcb));
+  pcb_shm[proc_id].generation = generation;
+  pcb_shm[proc_id].created_at = now;
+  has_run[proc_id] = 0;
+  pcb_shm[proc_id].cpu = find_least_loaded_cpu();
+  if (sched->on_create != NULL) {
+    sched->on_create(&cpus[pcb_shm[proc_id].cpu], &pcb_shm[proc_id]);
+  }
+  if (is_replaying) {
+    pcb_shm[proc_id].proc_class = arriving->proc_class;
+    cursors[proc_id].next = (const struct workload_burst*) (arriving + 1);
+    cursors[proc_id].num_bursts_left = arriving->num_bursts;
+  } else {
+    pcb_shm[proc_id].proc_class = rng_below(&rng, NUM_PROC_CLASSES);
+  }
+  pcb_shm[proc_id].tickets = class_tickets[pcb_shm[proc_id].proc_class];
+  if (realtime_percent > 0 && rng_below(&rng, 100) < realtime_percent) {
+    struct pcb* pcb = &pcb_shm[proc_id];
+    pcb->is_realtime = 1;
+    pcb->period = MIN_PERIOD + rng_below(&rng, MAX_PERIOD - MIN_PERIOD);
+    pcb->relative_deadline = pcb->period / 2 + rng_below(&rng, pcb->period / 2 + 1);
+    pcb->release_time = now;
+    pcb->deadline = now + pcb->relative_deadline;
+  }
+
   int priority = 0;
-  fprintf(
-    fp,
-    "[OSS] [%02d:%010d] Generating process %d and putting it in queue %d\n",
-    clock_shm->secs,
-    clock_shm->nanosecs,
-    proc_id,
-    priority
-  );
+  log_event(TR_GENERATE, proc_id, get_queue(proc_id));
   enqueue_process(proc_id, priority);
-  pid_t pid = fork();
+  switch (user_mode) {
+    case USER_POOL:
+      wakeup_post(&pcb_shm[proc_id].start_word);
+      break;
+    case USER_SPAWN:
+      child_pids[proc_id] = spawn_user(proc_id, 0);
+      break;
+    case USER_THREAD:
+      user_start(&user_procs[proc_id], proc_id, &pcb_shm[proc_id], seed);
+      break;
+  }
+}
 
-  if (pid == -1) {
-    perror("Failed to fork");
-    exit(EXIT_FAILURE);
+/**
+ * Starts user with vfork, which lends the child oss's address
+ * space until it execs instead of copying oss's page tables
+ * the way fork does. If the exec fails, the child sends its
+ * errno back through a close-on-exec pipe and oss exits,
+ * rather than waiting forever on a process that never ran.
+ *
+ * @param proc_id The PCB slot it runs in
+ * @param is_worker Whether it stays in the pool, running
+ *                  every process given its slot
+ * @return The process ID of user.
+ */
+static pid_t spawn_user(int proc_id, int is_worker) {
+  char proc_id_string[12];
+  sprintf(proc_id_string, "%d", proc_id);
+  char* args[] = {
+    "user",
+    proc_id_string,
+    shm_name,
+    seed_string,
+    is_worker ? "pool" : NULL,
+    NULL
+  };
+
+  int exec_pipe[2];
+  if (pipe(exec_pipe) == -1 ||
+      fcntl(exec_pipe[1], F_SETFD, FD_CLOEXEC) == -1) {
+    perror("Failed to create exec pipe");
+    kill_children_and_exit();
   }
 
-  if (pid == 0) { // Child
-    char proc_id_string[12];
-    char clock_seg_id_string[12];
-    char pcb_seg_id_string[12];
-    char curr_sched_seg_id_string[12];
-    char sem_id_string[12];
-    sprintf(proc_id_string, "%d", proc_id);
-    sprintf(clock_seg_id_string, "%d", clock_seg_id);
-    sprintf(pcb_seg_id_string, "%d", pcb_seg_id);
-    sprintf(curr_sched_seg_id_string, "%d", curr_sched_seg_id);
-    sprintf(sem_id_string, "%d", sem_id);
-
-    execlp(
-      "user",
-      "user",
-      proc_id_string,
-      clock_seg_id_string,
-      pcb_seg_id_string,
-      curr_sched_seg_id_string,
-      sem_id_string,
-      (char*) NULL
-    );
-    perror("Failed to exec");
+  pid_t pid = vfork();
+  if (pid == -1) {
+    perror("Failed to vfork");
+    kill_children_and_exit();
+  }
+  if (pid == 0) { // Child, which may only exec or _exit
+    close(exec_pipe[0]);
+    execvp("user", args);
+    int exec_errno = errno;
+    perror("Failed to exec user");
+    write(exec_pipe[1], &exec_errno, sizeof(exec_errno));
     _exit(EXIT_FAILURE);
   }
+
+  // oss only runs again once the child has exec'd or exited,
+  // so the pipe is already either closed or written to
+  close(exec_pipe[1]);
+  int exec_errno;
+  ssize_t num_read = read(exec_pipe[0], &exec_errno, sizeof(exec_errno));
+  close(exec_pipe[0]);
+  if (num_read > 0) {
+    waitpid(pid, NULL, 0);
+    kill_children_and_exit();
+  }
+  return pid;
 }
 
-static int is_past_last_created(struct my_clock create_at) {
-  int sec_past = create_at.secs - clock_shm->secs;
-  int ns_past = create_at.nanosecs - clock_shm->nanosecs;
-  int total_past = ns_past + (sec_past * NANOSECS_PER_SEC);
-  if (total_past < 0) {
-    return 1;
-  } else {
-    return 0;
+/**
+ * Kills every user process started so far, frees shared memory
+ * and exits, when oss can't carry on running processes.
+ */
+static void kill_children_and_exit(void) {
+  int i;
+  for (i = 0; i < max_running_procs; i++) {
+    if (child_pids[i] > 0) {
+      kill(child_pids[i], SIGKILL);
+      waitpid(child_pids[i], NULL, 0);
+    }
   }
+  free_shm();
+  exit(EXIT_FAILURE);
 }
 
 /**
- * Get a currently available process ID.
+ * Tells every worker in the pool to exit.
+ */
+static void retire_workers() {
+  int i;
+  for (i = 0; i < max_running_procs; i++) {
+    pcb_shm[i].should_exit = 1;
+    wakeup_post(&pcb_shm[i].start_word);
+  }
+}
+
+/**
+ * Advances the simulated clock and publishes it to the children
+ * with a single atomic store.
  *
- * @return The process ID. -1 if the process table is full.
+ * @param time The new time (in nanoseconds)
+ */
+static void set_clock(uint64_t time) {
+  now = time;
+  write_clock(clock_shm, time);
+}
+
+/**
+ * Handles an arrival event by generating a new process,
+ * if the process table has room, and scheduling the next arrival.
  */
-static int get_proc_id() {
-  int proc_id;
-  for (proc_id = 0; proc_id < MAX_PROCS; proc_id++) {
-    if (pcb_shm_ids[proc_id] != 1) {
-      return proc_id;
+static void generate_process() {
+  if (is_replaying) {
+    replay_arrival();
+    return;
+  }
+
+  if (num_procs_generated < max_procs) {
+    int proc_id = allocate_slot(&pcb_slots);  // -1 if process table is full
+    if (proc_id != -1) {
+      create_process(proc_id);
+      preempt_if_needed(proc_id);
     }
   }
-  return -1;
-}
 
-static int dispatch_process() {
-  int priority = 0;
+  if (num_procs_generated < max_procs) {
+    uint64_t create_at = now + rng_below(&rng, 3) * NANOSECS_PER_SEC;
+    schedule_event(&events, create_at, EV_ARRIVAL, -1, 0);
+  }
+}
 
-  fprintf(
-    fp,
-    "[OSS] [%02d:%010d] Dispatching process %d from queue %d\n",
-    clock_shm->secs,
-    clock_shm->nanosecs,
-    peek(priority),
-    priority
-  );
-
-  int pid = dequeue_process(0);
-  if (pid != -1) {
-    curr_sched_shm->proc_id = pid;
-    curr_sched_shm->time_quantum = MY_TIMESLICE;
-    curr_sched_shm->rand_sched_num = get_rand_sched_num();
+/**
+ * Handles an arrival event under -w by starting the workload's
+ * next process and scheduling the arrival of the one after it.
+ * When the process table is full, the process arrives as soon
+ * as a slot is released instead, see end_burst().
+ */
+static void replay_arrival() {
+  int proc_id = allocate_slot(&pcb_slots);
+  if (proc_id == -1) {
+    is_arrival_deferred = 1;
+    return;
+  }
+  create_process(proc_id);
+  preempt_if_needed(proc_id);
+
+  arriving = NULL;
+  if (num_procs_generated < max_procs) {
+    arriving = next_workload_proc(&workload);
+    uint64_t arrive_at = max_time(started_at + arriving->arrival, now);
+    schedule_event(&events, arrive_at, EV_ARRIVAL, -1, 0);
+  }
+  if (should_release_workload(&workload)) {
+    release_workload(&workload, find_oldest_burst());
   }
-  return pid;
 }
 
-static void enqueue_process(int proc_id, int priority) {
-  pcb_shm[proc_id].priority = priority;
-  struct entry* proc = malloc(sizeof(struct entry));
-  proc->pid = proc_id;
-  switch (priority) {
-    case 0:
-      TAILQ_INSERT_TAIL(&high_prio_queue, proc, entries);
-      print_queues();
-      break;
-    case 1:
-      TAILQ_INSERT_TAIL(&med_prio_queue, proc, entries);
-      print_queues();
-      break;
-    case 2:
-      TAILQ_INSERT_TAIL(&low_prio_queue, proc, entries);
-      print_queues();
-      break;
+/**
+ * @return The first byte of the workload a process that has
+ *         arrived, or the next one to arrive, still needs.
+ */
+static const void* find_oldest_burst() {
+  const char* oldest = arriving != NULL ? (const char*) arriving
+                                        : workload.map + workload.size;
+  int i;
+  for (i = 0; i < max_running_procs; i++) {
+    if (cursors[i].next == NULL) {
+      continue; // No process in the slot
+    }
+    const char* burst = (const char*) (cursors[i].next - 1);
+    if (burst < oldest) {
+      oldest = burst;
+    }
   }
+  return oldest;
 }
 
-static int peek(int priority) {
-  int pid = -1;
-  struct entry* np;
-  switch (priority) {
-    case 0:
-      np = TAILQ_FIRST(&high_prio_queue);
-      if (np != NULL) {
-        pid = np->pid;
-      }
-      break;
-    case 1:
-      np = TAILQ_FIRST(&med_prio_queue);
-      if (np != NULL) {
-        pid = np->pid;
+/**
+ * Finds an idle CPU with something to run, preferring one
+ * with processes in its own queues over one that has to steal.
+ *
+ * @return The CPU, or -1 if no idle CPU has anything to run.
+ */
+static int find_idle_cpu() {
+  if (num_queued == 0) {
+    return -1;
+  }
+  int i;
+  int idle_cpu = -1;
+  for (i = 0; i < num_cpus; i++) {
+    if (cpus[i].running_proc_id == -1) {
+      if (cpus[i].num_queued > 0) {
+        return i;
       }
-      break;
-    case 2:
-      np = TAILQ_FIRST(&low_prio_queue);
-      if (np != NULL) {
-        pid = np->pid;
+      if (idle_cpu == -1) {
+        idle_cpu = i;
       }
-      break;
+    }
+  }
+  return idle_cpu;
+}
 
+/**
+ * @return The CPU with the most processes in its queues.
+ */
+static int find_busiest_cpu() {
+  int i;
+  int busiest = 0;
+  for (i = 1; i < num_cpus; i++) {
+    if (cpus[i].num_queued > cpus[busiest].num_queued) {
+      busiest = i;
+    }
   }
-  return pid;
+  return busiest;
 }
 
-static int dequeue_process(int priority) {
-  int pid = -1;
-  struct entry* np;
-  switch (priority) {
-    case 0:
-      np = TAILQ_FIRST(&high_prio_queue);
-      if (np != NULL) {
-        pid = np->pid;
-        TAILQ_REMOVE(&high_prio_queue, np, entries);
-        free(np);
-        print_queues();
-      }
-      break;
-    case 1:
-      np = TAILQ_FIRST(&med_prio_queue);
-      if (np != NULL) {
-        pid = np->pid;
-        TAILQ_REMOVE(&med_prio_queue, np, entries);
-        free(np);
-        print_queues();
-      }
-      break;
-    case 2:
-      np = TAILQ_FIRST(&low_prio_queue);
-      if (np != NULL) {
-        pid = np->pid;
-        TAILQ_REMOVE(&low_prio_queue, np, entries);
-        free(np);
-        print_queues();
+/**
+ * @return The CPU with the fewest processes queued or running,
+ *         where a new process goes.
+ */
+static int find_least_loaded_cpu() {
+  int i;
+  int least_loaded = 0;
+  int least_load = INT_MAX;
+  for (i = 0; i < num_cpus; i++) {
+    int load = cpus[i].num_queued + (cpus[i].running_proc_id != -1);
+    if (load < least_load) {
+      least_loaded = i;
+      least_load = load;
+    }
+  }
+  return least_loaded;
+}
+
+/**
+ * Dispatches a process on every idle CPU that has something to run,
+ * so the processes run at the same time on the host's cores. Then
+ * collects each process's report of its burst and schedules the end
+ * of that burst.
+ *
+ * The next event can't be handled until every burst is reported,
+ * since a burst may end before it. Completions are handled in the
+ * order the processes were dispatched, so the log doesn't depend
+ * on which process the host happened to finish first.
+ *
+ * @return The number of processes dispatched.
+ */
+static int run_ready_processes() {
+  int num_dispatched = 0;
+  int cpu;
+  while ((cpu = find_idle_cpu()) != -1) {
+    // Scheduling Overhead
+    set_clock(now + rng_below(&rng, 1001));
+
+    int pid = dispatch_process(cpu);
+    cpus[cpu].running_proc_id = pid;
+    dispatched_pids[num_dispatched] = pid;
+    dispatched_cpus[num_dispatched] = cpu;
+    num_dispatched++;
+  }
+
+  int i;
+  for (i = 0; i < num_dispatched && user_mode != USER_THREAD; i++) {
+    wakeup_wait(&curr_sched_shm[dispatched_cpus[i]].done_word);
+  }
+  drain_log_rings(dispatched_pids, num_dispatched);
+
+  for (i = 0; i < num_dispatched; i++) {
+    int pid = dispatched_pids[i];
+    struct curr_sched* sched = &curr_sched_shm[dispatched_cpus[i]];
+    log_event(TR_BURST_END, pid, pcb_shm[pid].last_burst_time);
+    cpus[dispatched_cpus[i]].busy_time += pcb_shm[pid].last_burst_time;
+    cpus[dispatched_cpus[i]].num_bursts++;
+
+    int type = sched->rand_sched_num == 3 ? EV_PREEMPT : EV_BURST_COMPLETE;
+    uint64_t end_at = sched->dispatched_at + pcb_shm[pid].last_burst_time;
+    cpus[dispatched_cpus[i]].burst_event_seq =
+      schedule_event(&events, end_at, type, pid, pcb_shm[pid].generation);
+  }
+  return num_dispatched;
+}
+
+/**
+ * Handles the end of a burst: the process terminates,
+ * blocks on an event, or goes back into a ready queue.
+ *
+ * @param proc_id The process that was using the CPU
+ */
+static void end_burst(int proc_id) {
+  struct pcb* pcb = &pcb_shm[proc_id];
+  hist_record(&burst_hist, pcb->last_burst_time);
+  if (!pcb->ready_to_terminate) {
+    move_process(proc_id);
+  }
+  // A real-time burst that ran to its end finishes the current job
+  if (pcb->is_realtime && !pcb->was_interrupted) {
+    end_job(proc_id);
+  }
+
+  if (pcb->ready_to_terminate) {
+    num_procs_completed++;
+    uint64_t total_sys_time = subtract_times(now, pcb->created_at);
+    stats_add(&turnaround_stats, total_sys_time);
+    stats_add(&wait_stats, subtract_times(total_sys_time, pcb->total_cpu_time));
+    hist_record(&turnaround_hist, total_sys_time);
+    double cpu_share = total_sys_time > 0 ?
+      (double) pcb->total_cpu_time / total_sys_time : 0;
+    stats_add(&cpu_share_stats, cpu_share);
+    stats_add(&class_cpu_share_stats[pcb->proc_class], cpu_share);
+    num_log_records_dropped += pcb->log.dropped;
+    log_event(TR_TERMINATE, proc_id, num_procs_completed);
+    if (user_mode == USER_SPAWN) {
+      waitpid(child_pids[proc_id], NULL, 0);
+      child_pids[proc_id] = 0;
+    }
+    release_slot(&pcb_slots, proc_id);
+    if (is_replaying) {
+      cursors[proc_id].next = NULL;
+      if (is_arrival_deferred) {
+        is_arrival_deferred = 0;
+        schedule_event(&events, now, EV_ARRIVAL, -1, 0);
       }
-      break;
+    }
+  } else if (pcb->event_wait_time > 0) {
+    uint64_t wake_at = now + pcb->event_wait_time;
+    pcb->event_wait_time = 0;
+    log_event(TR_EVENT_WAIT, proc_id, wake_at);
+    schedule_event(&events, wake_at, EV_EVENT_WAKEUP, proc_id, pcb->generation);
+  } else if (pcb->is_realtime && pcb->release_time > now) {
+    schedule_event(&events, pcb->release_time, EV_RELEASE, proc_id,
+                   pcb->generation);
+  } else {
+    log_event(TR_REQUEUE, proc_id, get_queue(proc_id));
+    enqueue_process(proc_id, pcb->priority);
+  }
+}
+
+/**
+ * Records how late a real-time process finished its job,
+ * and works out when its next job is released and due.
+ *
+ * @param proc_id The real-time process
+ */
+static void end_job(int proc_id) {
+  struct pcb* pcb = &pcb_shm[proc_id];
+  int64_t lateness = (int64_t) now - (int64_t) pcb->deadline;
+  int bucket = 0;
+  int64_t limit = 1000000; // 1 millisecond in nanoseconds
+  if (lateness > 0) {
+    num_missed_deadlines++;
+    for (bucket = 1; bucket < NUM_LATENESS_BUCKETS - 1 && lateness > limit;
+         bucket++) {
+      limit *= 10;
+    }
+  }
+  lateness_buckets[bucket]++;
+  stats_add(&lateness_stats, lateness);
+  log_event(TR_JOB_END, proc_id, (uint64_t) lateness);
+
+  pcb->release_time += pcb->period;
+  pcb->deadline = pcb->release_time + pcb->relative_deadline;
+}
 
+/**
+ * @param proc_id The process
+ * @return The queue a process goes in, for the log.
+ */
+static uint32_t get_queue(int proc_id) {
+  if (pcb_shm[proc_id].is_realtime) {
+    return TR_REALTIME_QUEUE;
+  }
+  return pcb_shm[proc_id].priority;
+}
+
+/**
+ * Lets the policy charge a process for its burst, and moves the
+ * process to another queue if the policy says so.
+ *
+ * @param proc_id The process that just finished a burst
+ */
+static void move_process(int proc_id) {
+  struct pcb* pcb = &pcb_shm[proc_id];
+  if (pcb->is_realtime) {
+    return; // Real-time processes are ordered by deadline alone
+  }
+
+  int level = sched->on_burst_complete(&cpus[pcb->cpu], pcb);
+  if (level != pcb->priority) {
+    log_event(TR_MOVE, proc_id, (uint64_t) pcb->priority << 32 | level);
+    pcb->priority = level;
+  }
+}
+
+/**
+ * Preempts the process running on a newly ready process's CPU if the
+ * new process should run first: a real-time process goes ahead of a
+ * best-effort process or one with a later deadline, and under shortest
+ * remaining time first, a process goes ahead of one expected to take
+ * longer. The preempted process keeps the rest of its burst for when
+ * it runs again.
+ *
+ * Bursts that end in termination or an event wait are left alone,
+ * since their process has already acted on them.
+ *
+ * @param proc_id The process that just became ready
+ */
+static void preempt_if_needed(int proc_id) {
+  struct pcb* arrival = &pcb_shm[proc_id];
+  int cpu = arrival->cpu;
+  int running_pid = cpus[cpu].running_proc_id;
+  if (running_pid == -1) {
+    return;
+  }
+  struct pcb* pcb = &pcb_shm[running_pid];
+  if (pcb->ready_to_terminate || pcb->event_wait_time > 0) {
+    return;
+  }
+
+  uint64_t ran = subtract_times(now, curr_sched_shm[cpu].dispatched_at);
+  uint64_t left = subtract_times(pcb->last_burst_time, ran);
+  int should_preempt;
+  if (arrival->is_realtime) {
+    should_preempt = !pcb->is_realtime || arrival->deadline < pcb->deadline;
+  } else {
+    should_preempt = sched->check_preempt != NULL && !pcb->is_realtime &&
+                     sched->check_preempt(&cpus[cpu], proc_id, left);
+  }
+  if (!should_preempt || left == 0) {
+    return;
+  }
+
+  log_event(TR_PREEMPT, running_pid, (uint64_t) proc_id << 32 | ran);
+  pcb->last_burst_time = ran;
+  pcb->total_cpu_time -= left;
+  pcb->remaining_time += left;
+  pcb->was_interrupted = 1;
+  cpus[cpu].busy_time -= left;
+  cpus[cpu].running_proc_id = -1;
+  cpus[cpu].burst_event_seq = ULONG_MAX; // Its burst event is now stale
+  end_burst(running_pid);
+}
+
+/**
+ * Takes the next process from a CPU's queues and wakes it up.
+ * A CPU with empty queues steals from the CPU with the most
+ * processes waiting.
+ *
+ * @param cpu The CPU to run the process on
+ * @return The process ID, or -1 if there was nothing to run.
+ */
+static int dispatch_process(int cpu) {
+  int from_cpu = cpus[cpu].num_queued > 0 ? cpu : find_busiest_cpu();
+  int priority;
+  uint64_t wait;
+  int pid = dequeue_process(from_cpu, &priority, &wait);
+  if (pid == -1) {
+    return -1;
+  }
+  cpus[from_cpu].num_queued--;
+  num_queued--;
+
+  record_wait(&all_waits, wait);
+  if (pcb_shm[pid].is_realtime) {
+    record_wait(&realtime_waits, wait);
+  } else {
+    record_wait(get_queue_waits(num_queues > 1 ? priority : 0), wait);
+  }
+  if (!has_run[pid]) {
+    has_run[pid] = 1;
+    hist_record(&response_hist, subtract_times(now, pcb_shm[pid].created_at));
+  }
+  if (from_cpu != cpu) {
+    if (sched->migrate != NULL && !pcb_shm[pid].is_realtime) {
+      sched->migrate(&cpus[from_cpu], &cpus[cpu], &pcb_shm[pid]);
+    }
+    cpus[cpu].num_steals++;
+    log_event(TR_STEAL, pid, (uint64_t) from_cpu << 32 | cpu);
+  }
+  print_queues(from_cpu);
+  log_event(TR_DISPATCH, pid, (uint64_t) from_cpu << 32 | get_queue(pid));
+
+  struct curr_sched* sched = &curr_sched_shm[cpu];
+  pcb_shm[pid].cpu = cpu;
+  pcb_shm[pid].last_wait_time = wait;
+  sched->proc_id = pid;
+  sched->time_quantum = get_time_quantum(from_cpu, pid, priority);
+  if (is_replaying) {
+    read_workload_burst(pid, sched);
+  } else {
+    sched->rand_sched_num = get_rand_sched_num();
+  }
+  sched->dispatched_at = now;
+  if (user_mode == USER_THREAD) {
+    // The burst runs to its end right away, as if the process
+    // had been woken and oss had waited for it
+    user_run_burst(&user_procs[pid], sched);
+  } else {
+    wakeup_post(&pcb_shm[pid].wait_word);
   }
   return pid;
 }
 
-static int is_queue_empty() {
-  return TAILQ_EMPTY(&high_prio_queue);
+/**
+ * Takes the next process from a CPU's ready queues.
+ *
+ * @param cpu The CPU whose queues to take from
+ * @param priority Where to store the queue it came from
+ * @param wait Where to store how long it waited (in nanoseconds)
+ * @return The process ID, or -1 if the queues are empty.
+ */
+static int dequeue_process(int cpu, int* priority, uint64_t* wait) {
+  if (!heap_rq_is_empty(&cpus[cpu].edf)) {
+    *priority = 0;
+    return heap_rq_dequeue(&cpus[cpu].edf, now, wait);
+  }
+  return sched->pick_next(&cpus[cpu], pcb_shm, priority, now, wait);
 }
 
-static void free_queue() {
-  struct entry *n1, *n2;
-  n1 = TAILQ_FIRST(&high_prio_queue);
-  while (n1 != NULL) {
-    n2 = TAILQ_NEXT(n1, entries);
-    free(n1);
-    n1 = n2;
+/**
+ * @param cpu The CPU whose queues the process was just taken from
+ * @param proc_id The process
+ * @param priority The queue it came from
+ * @return How long the process may run for (in nanoseconds)
+ */
+static unsigned int get_time_quantum(int cpu, int proc_id, int priority) {
+  if (pcb_shm[proc_id].is_realtime) {
+    return quantum;
   }
+  return sched->get_time_quantum(&cpus[cpu], &pcb_shm[proc_id], priority);
+}
+
+static void enqueue_process(int proc_id, int priority) {
+  struct pcb* pcb = &pcb_shm[proc_id];
+  int cpu = pcb->cpu;
+  pcb->priority = priority;
+  if (pcb->is_realtime) {
+    heap_rq_enqueue(&cpus[cpu].edf, proc_id, pcb->deadline, now);
+  } else {
+    sched->enqueue(&cpus[cpu], proc_id, pcb, now);
+  }
+  cpus[cpu].num_queued++;
+  num_queued++;
+  log_event(TR_ENQUEUE, proc_id, (uint64_t) cpu << 32 | get_queue(proc_id));
+  print_queues(cpu);
+}
+
+/**
+ * Works out from the workload what a process does when it's
+ * dispatched: it runs the rest of its current burst, or else its
+ * next burst, for up to its time quantum. Then it's preempted if
+ * the burst isn't done, or else it terminates after its last
+ * burst or waits for I/O.
+ *
+ * @param proc_id The process being dispatched
+ * @param sched The CPU it's dispatched on, with its time quantum set
+ */
+static void read_workload_burst(int proc_id, struct curr_sched* sched) {
+  struct pcb* pcb = &pcb_shm[proc_id];
+  struct workload_cursor* cursor = &cursors[proc_id];
+  if (!pcb->was_interrupted) {
+    cursor->next++;
+    cursor->num_bursts_left--;
+  }
+  const struct workload_burst* burst = cursor->next - 1;
+  unsigned int needed = pcb->was_interrupted ? pcb->remaining_time
+                                             : burst->cpu_time;
+  sched->burst_time = needed < sched->time_quantum ? needed : sched->time_quantum;
+  sched->burst_left = needed - sched->burst_time;
+  int is_burst_done = sched->burst_left == 0;
+  sched->is_last_burst = is_burst_done && cursor->num_bursts_left == 0;
+  sched->io_wait = is_burst_done && !sched->is_last_burst ?
+    (uint64_t) burst->io_wait * 1000 : 0;
+
+  // See get_rand_sched_num(), which run_ready_processes() goes by
+  sched->rand_sched_num = !is_burst_done ? 3 : sched->io_wait > 0 ? 2 : 1;
 }
 
 /**
@@ -554,53 +1434,96 @@ static void free_queue() {
  *     [1, 99] of its time quantum
  */
 static int get_rand_sched_num() {
-  int rand_sched_num = rand() % 3 + 1;
-  
+  int rand_sched_num = rng_below(&rng, 3) + 1;
+
   // Make 1 a more likely outcome
-  int i; 
+  int i = 0;
   while (rand_sched_num != 1 && i < 3) {
-    rand_sched_num = rand() % 3 + 1;
+    rand_sched_num = rng_below(&rng, 3) + 1;
     i++;
   }
   return rand_sched_num;
 }
 
-/*----------------------------*
- | TODO: Print report         |
- |----------------------------|
- | - Average turnaround time  |
- | - Average wait time        |
- | - How long CPU was idle    |
- *----------------------------*/
+/**
+ * Records a wait in a queue.
+ */
+static void record_wait(struct queue_waits* waits, uint64_t wait) {
+  stats_add(&waits->stats, wait);
+  hist_record(&waits->hist, wait);
+}
+
+/**
+ * @param queue A queue of the policy
+ * @return The waits recorded in it, allocated the first time.
+ */
+static struct queue_waits* get_queue_waits(int queue) {
+  if (queue_waits[queue] == NULL) {
+    queue_waits[queue] = malloc(sizeof(struct queue_waits));
+    if (queue_waits[queue] == NULL) {
+      perror("Failed to allocate queue waits");
+      exit(EXIT_FAILURE);
+    }
+    init_running_stats(&queue_waits[queue]->stats);
+    init_histogram(&queue_waits[queue]->hist);
+  }
+  return queue_waits[queue];
+}
+
+/**
+ * Prints a one-line summary of the run so far to stderr,
+ * when asked to with SIGUSR1.
+ */
+static void print_progress() {
+  struct my_clock now_view = get_clock_view(now);
+  fprintf(stderr, "oss: %02d:%010d completed %ld/%ld, events %lu, "
+          "turnaround avg %.0f sd %.0f ns, wait avg %.0f sd %.0f ns\n",
+          now_view.secs, now_view.nanosecs,
+          num_procs_completed, max_procs, num_events,
+          turnaround_stats.mean, stats_get_stddev(&turnaround_stats),
+          wait_stats.mean, stats_get_stddev(&wait_stats));
+}
+
+/**
+ * Prints the 50th, 90th, 99th and 99.9th percentiles and
+ * the maximum of a distribution of times.
+ *
+ * @param name What the times are
+ * @param h The distribution
+ */
+static void print_percentiles(const char* name, const struct histogram* h) {
+  static const double percentiles[] = { 50, 90, 99, 99.9 };
+  if (h->total == 0) {
+    return;
+  }
+  fprintf(fp, "%s:", name);
+  int i;
+  for (i = 0; i < 4; i++) {
+    struct my_clock view = get_clock_view(hist_get_percentile(h, percentiles[i]));
+    fprintf(fp, " p%g %d:%09d,", percentiles[i], view.secs, view.nanosecs);
+  }
+  struct my_clock max_view = get_clock_view(h->max);
+  fprintf(fp, " max %d:%09d \n", max_view.secs, max_view.nanosecs);
+}
+
+/**
+ * Prints the average, spread and percentiles of the waits in a queue.
+ */
+static void print_queue_waits(const char* name, const struct queue_waits* waits) {
+  fprintf(fp, "Wait Time in %s: Average %.0f, Std Dev %.0f, Min %.0f, Max %.0f nanoseconds \n",
+          name, waits->stats.mean, stats_get_stddev(&waits->stats),
+          waits->stats.min, waits->stats.max);
+  char percentiles_name[48];
+  sprintf(percentiles_name, "%s Wait Time", name);
+  print_percentiles(percentiles_name, &waits->hist);
+}
+
+/**
+ * Prints the report at the end of the log file.
+ */
 static void print_report() {
-  struct my_clock total_turnaround_time;
-  total_turnaround_time.secs = 0;
-  total_turnaround_time.nanosecs = 0;
-  struct my_clock total_cpu_time;
-  // printf("\n\nGenerating report...\n");
   int i;
-  for (i = 0; i < MAX_PROCS; i++) {
-    // printf("Process %d | Total System Time %d:%d | Total CPU Time %d:%d \n", i, pcb_shm[i].total_sys_time.secs, pcb_shm[i].total_sys_time.nanosecs, pcb_shm[i].total_cpu_time.secs, pcb_shm[i].total_cpu_time.nanosecs);
-    // printf("%d:%d + %d:%d = ", total_turnaround_time.secs, total_turnaround_time.nanosecs, pcb_shm[i].total_sys_time.secs, pcb_shm[i].total_sys_time.nanosecs);
-    total_turnaround_time = add_clocks(
-                              total_turnaround_time,
-                              pcb_shm[i].total_sys_time
-                            );
-    // printf("%d:%d\n", total_turnaround_time.secs, total_turnaround_time.nanosecs);
-    total_cpu_time = add_clocks(
-                       total_cpu_time,
-                       pcb_shm[i].total_cpu_time
-                     );
-  }
-  // printf("\nTotal turnaround time %d:%d\n\n", total_turnaround_time.secs, total_turnaround_time.nanosecs);
-  struct my_clock avg_turnaround_time;
-  avg_turnaround_time = divide_clock(total_turnaround_time, MAX_PROCS);
-  struct my_clock avg_cpu_time;
-  avg_cpu_time = divide_clock(total_cpu_time, MAX_PROCS);
-  struct my_clock avg_wait_time;
-  avg_wait_time = subtract_clocks(avg_turnaround_time, avg_cpu_time);
-
-  char report_title[33] = "Operating System Simulator Report";
+  char report_title[] = "Operating System Simulator Report";
   fprintf(fp, "\n%s\n", report_title);
   int j = 0;
   while (report_title[j] != '\0') {
@@ -608,16 +1531,98 @@ static void print_report() {
     j++;
   }
   fprintf(fp, "\n");
-  fprintf(fp, "Average Turnaround Time: %d:%d \n", avg_turnaround_time.secs, avg_turnaround_time.nanosecs);
-  fprintf(fp, "Average Wait Time: %d:%d \n", avg_wait_time.secs, avg_wait_time.nanosecs);
-}
+  fprintf(fp, "Seed: %llu \n", (unsigned long long) seed);
+  fprintf(fp, "Processes Completed: %ld \n", num_procs_completed);
+  fprintf(fp, "Events Handled: %lu \n", num_events);
+  struct my_clock avg_turnaround_view = get_clock_view(turnaround_stats.mean);
+  struct my_clock avg_wait_view = get_clock_view(wait_stats.mean);
+  fprintf(fp, "Average Turnaround Time: %d:%09d \n", avg_turnaround_view.secs, avg_turnaround_view.nanosecs);
+  fprintf(fp, "Average Wait Time: %d:%09d \n", avg_wait_view.secs, avg_wait_view.nanosecs);
+  if (turnaround_stats.count > 0) {
+    fprintf(fp, "Turnaround Time Std Dev: %.0f nanoseconds, Min %.0f nanoseconds \n",
+            stats_get_stddev(&turnaround_stats), turnaround_stats.min);
+    fprintf(fp, "Wait Time Std Dev: %.0f nanoseconds, Min %.0f nanoseconds \n",
+            stats_get_stddev(&wait_stats), wait_stats.min);
+  }
+  if (cpu_share_stats.count > 0 && cpu_share_stats.mean > 0) {
+    // 1.00 when every process got the same share of the CPU.
+    // Jain's index is mean^2 / mean of the squares.
+    double mean_squared = cpu_share_stats.mean * cpu_share_stats.mean;
+    fprintf(fp, "Fairness (Jain's index of CPU share): %.4f \n",
+            mean_squared / (stats_get_variance(&cpu_share_stats) + mean_squared));
+  }
+  print_percentiles("Turnaround Time", &turnaround_hist);
+  print_percentiles("Response Time", &response_hist);
+  print_percentiles("Ready Queue Wait Time", &all_waits.hist);
+  print_percentiles("Burst Length", &burst_hist);
+  for (i = 0; i < num_queues; i++) {
+    if (queue_waits[i] != NULL) {
+      char name[48];
+      if (num_queues > 1) {
+        sprintf(name, "Queue %d", i);
+      } else {
+        sprintf(name, "Run Queue");
+      }
+      print_queue_waits(name, queue_waits[i]);
+    }
+  }
 
-/**
- * TODO: Write method to calculate average
- *       wait time of processes in queue "X"
- */
+  if (lateness_stats.count > 0) {
+    fprintf(fp, "Real-Time Jobs: %lu, Missed Deadlines %lu (%.2f%%) \n",
+            lateness_stats.count, num_missed_deadlines,
+            100.0 * num_missed_deadlines / lateness_stats.count);
+    fprintf(fp, "Average Lateness: %.0f nanoseconds, Max Lateness: %.0f nanoseconds, "
+            "Std Dev %.0f nanoseconds \n",
+            lateness_stats.mean, lateness_stats.max,
+            stats_get_stddev(&lateness_stats));
+    fprintf(fp, "Lateness Distribution:");
+    for (i = 0; i < NUM_LATENESS_BUCKETS; i++) {
+      fprintf(fp, " %s %lu%s", lateness_bucket_names[i], lateness_buckets[i],
+              i < NUM_LATENESS_BUCKETS - 1 ? "," : " \n");
+    }
+    if (realtime_waits.stats.count > 0) {
+      print_queue_waits("Real-Time Queue", &realtime_waits);
+    }
+  }
 
-/**
- * TODO: Write method to move process to
- *       another queue
- */
\ No newline at end of file
+  // Share of the CPU each class got while in the system, to compare with its tickets
+  for (i = 0; i < NUM_PROC_CLASSES; i++) {
+    if (class_cpu_share_stats[i].count > 0) {
+      fprintf(fp, "Class %s: Completed %lu, Tickets %u, Average CPU Share %.2f%% \n",
+              class_names[i], class_cpu_share_stats[i].count, class_tickets[i],
+              100.0 * class_cpu_share_stats[i].mean);
+    }
+  }
+
+  // Per-CPU utilization and how evenly the work was spread
+  uint64_t elapsed = subtract_times(now, started_at);
+  uint64_t max_busy_time = 0;
+  uint64_t total_busy_time = 0;
+  unsigned long total_steals = 0;
+  for (i = 0; i < num_cpus; i++) {
+    struct my_clock idle_view = get_clock_view(subtract_times(elapsed, cpus[i].busy_time));
+    fprintf(fp, "CPU %d: Utilization %.2f%%, Idle Time %d:%09d, Bursts %lu, Steals %lu \n", i,
+            elapsed > 0 ? 100.0 * cpus[i].busy_time / elapsed : 0.0,
+            idle_view.secs, idle_view.nanosecs,
+            cpus[i].num_bursts, cpus[i].num_steals);
+    total_busy_time += cpus[i].busy_time;
+    total_steals += cpus[i].num_steals;
+    if (cpus[i].busy_time > max_busy_time) {
+      max_busy_time = cpus[i].busy_time;
+    }
+  }
+  struct my_clock total_idle_view =
+    get_clock_view(subtract_times(elapsed * num_cpus, total_busy_time));
+  fprintf(fp, "All CPUs: Utilization %.2f%%, Idle Time %d:%09d \n",
+          elapsed > 0 ? 100.0 * total_busy_time / (elapsed * num_cpus) : 0.0,
+          total_idle_view.secs, total_idle_view.nanosecs);
+  fprintf(fp, "Total Steals: %lu \n", total_steals);
+  if (total_busy_time > 0) {
+    // 1.00 when every CPU was busy for the same amount of time
+    fprintf(fp, "Load Imbalance (busiest CPU / average): %.2f \n",
+            (double) max_busy_time * num_cpus / total_busy_time);
+  }
+  if (num_log_records_dropped > 0) {
+    fprintf(fp, "User Log Records Dropped: %lu \n", num_log_records_dropped);
+  }
+}
@@ -1,28 +1,32 @@
 #ifndef OSS_H
 #define OSS_H
 
+#include "sched.h"
+#include "hist.h"
+#include "stats.h"
+#include "usersim.h"
+
 /**************
  * STRUCTURES *
  **************/
 
-
 /*
- * Multi-level Feedback Queue
- * --------------------------*/
-struct my_mlfq {
-
+ * Waits in a ready queue, for the report
+ * --------------------------------------*/
+struct queue_waits {
+  struct running_stats stats;
+  struct histogram hist;
 };
 
-// =================================================================
-
-
-/*************
- * CONSTANTS *
- *************/
 
-#define MY_TIMESLICE 100000000; // 100 milliseconds in nanoseconds
-#define ALPHA = 1;
-#define BETA = 2;
+/*
+ * How simulated processes are run, see -u
+ * ---------------------------------------*/
+enum user_mode {
+  USER_POOL,   // By user workers started up front, one per PCB
+  USER_SPAWN,  // By a user process started for each process
+  USER_THREAD  // Inside oss, see usersim.h
+};
 
 // =================================================================
 
@@ -30,6 +34,10 @@ struct my_mlfq {
 /**************
  * PROTOTYPES *
  **************/
+static void log_event(int type, int proc_id, uint64_t arg);
+static void log_user_record(struct trace_record* rec);
+static void drain_log_rings(const int* proc_ids, int num_procs);
+static void print_queues(int cpu);
 static int setup_interrupt(void);
 static void free_shm(void);
 static void free_shm_and_abort(int s);
@@ -37,15 +45,36 @@ static void print_help_message(char* executable_name,
                                char* log_file);
 static int is_required_argument(char optopt);
 static void print_required_argument_message(char optopt);
-static void fork_and_exec_child(int proc_id);
-static int is_past_last_created(struct my_clock create_at);
-static int get_proc_id();
-static int dispatch_process();
+static int parse_class_tickets(char* tickets);
+static void create_process(int proc_id);
+static pid_t spawn_user(int proc_id, int is_worker);
+static void kill_children_and_exit(void);
+static void retire_workers(void);
+static void set_clock(uint64_t time);
+static void generate_process();
+static void replay_arrival();
+static const void* find_oldest_burst();
+static int find_idle_cpu();
+static int find_busiest_cpu();
+static int find_least_loaded_cpu();
+static int run_ready_processes();
+static void end_burst(int proc_id);
+static void move_process(int proc_id);
+static void preempt_if_needed(int proc_id);
+static void end_job(int proc_id);
+static uint32_t get_queue(int proc_id);
+static int dequeue_process(int cpu, int* priority, uint64_t* wait);
+static unsigned int get_time_quantum(int cpu, int proc_id, int priority);
+static int dispatch_process(int cpu);
 static void enqueue_process(int proc_id, int priority);
-static int dequeue_process(int priority);
-static int is_queue_empty();
-static int peek(int priority);
+static void read_workload_burst(int proc_id, struct curr_sched* sched);
 static int get_rand_sched_num();
+static void record_wait(struct queue_waits* waits, uint64_t wait);
+static struct queue_waits* get_queue_waits(int queue);
+static void request_progress(int s);
+static void print_progress(void);
+static void print_percentiles(const char* name, const struct histogram* h);
+static void print_queue_waits(const char* name, const struct queue_waits* waits);
 static void print_report();
 
 #endif
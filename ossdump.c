@@ -0,0 +1,133 @@
+/**
+ * Operating System Simulator Trace Dump
+ *
+ * Converts a binary trace written by `oss -t` back into
+ * the human-readable log format.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+#include "readyq.h"
+#include "policy.h"
+
+static int is_queue_record_valid(const struct trace_record* rec,
+                                 const struct trace_header* header);
+
+int main(int argc, char* argv[]) {
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s trace_file\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int fd = open(argv[1], O_RDONLY);
+  if (fd == -1) {
+    perror("Failed to open trace file");
+    return EXIT_FAILURE;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    perror("Failed to stat trace file");
+    return EXIT_FAILURE;
+  }
+  if (st.st_size < (off_t) sizeof(struct trace_header)) {
+    fprintf(stderr, "%s is too short to be a trace.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  char* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    perror("Failed to map trace file");
+    return EXIT_FAILURE;
+  }
+
+  struct trace_header* header = (struct trace_header*) map;
+  if (header->magic != TRACE_MAGIC ||
+      header->version != TRACE_VERSION ||
+      header->record_size != sizeof(struct trace_record)) {
+    fprintf(stderr, "%s is not a version %d trace.\n", argv[1], TRACE_VERSION);
+    return EXIT_FAILURE;
+  }
+  if (header->num_levels == 0 || header->num_cpus == 0 || header->num_procs == 0) {
+    fprintf(stderr, "%s has no queues, CPUs or processes.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  // Rebuild the ready queues so their contents can be printed.
+  // oss only prints them for policies with numbered queues.
+  // A process is in at most one queue, so the CPUs can share links.
+  int num_levels = header->num_levels;
+  int num_cpus = header->num_cpus;
+  int has_queues = policy_has_levels(header->policy);
+  struct ready_links links;
+  init_ready_links(&links, header->num_procs);
+  struct ready_queue* levels = malloc(sizeof(struct ready_queue) * num_levels * num_cpus);
+  if (levels == NULL) {
+    perror("Failed to allocate ready queues");
+    return EXIT_FAILURE;
+  }
+  int i;
+  for (i = 0; i < num_levels * num_cpus; i++) {
+    init_ready_queue(&levels[i]);
+  }
+
+  struct trace_record* rec = (struct trace_record*) (map + sizeof(struct trace_header));
+  struct trace_record* end = (struct trace_record*) (map + st.st_size);
+  for (; rec + 1 <= end; rec++) {
+    int is_queue_record = rec->type == TR_ENQUEUE || rec->type == TR_DISPATCH;
+    if (has_queues && is_queue_record && !is_queue_record_valid(rec, header)) {
+      fprintf(stderr, "%s is corrupt: record %ld names a CPU, queue or process "
+              "that isn't in the trace.\n", argv[1],
+              (long) (rec - (struct trace_record*) (map + sizeof(struct trace_header))));
+      return EXIT_FAILURE;
+    }
+    int cpu = rec->arg >> 32;
+    struct ready_queue* cpu_levels = has_queues && is_queue_record ?
+      &levels[cpu * num_levels] : NULL;
+    switch (has_queues ? rec->type : -1) {
+      case TR_ENQUEUE:
+        // Real-time processes are in a heap that oss doesn't print
+        if ((rec->arg & 0xffffffff) != TR_REALTIME_QUEUE) {
+          ready_queue_push(&cpu_levels[rec->arg & 0xffffffff], &links, rec->proc_id);
+        }
+        print_ready_queues(stdout, cpu, num_cpus, cpu_levels, num_levels, &links);
+        break;
+      case TR_DISPATCH:
+        if ((rec->arg & 0xffffffff) != TR_REALTIME_QUEUE) {
+          ready_queue_remove(&cpu_levels[rec->arg & 0xffffffff], &links, rec->proc_id);
+        }
+        print_ready_queues(stdout, cpu, num_cpus, cpu_levels, num_levels, &links);
+        print_trace_record(stdout, rec, num_cpus);
+        break;
+      default:
+        print_trace_record(stdout, rec, num_cpus);
+    }
+  }
+
+  free(levels);
+  free_ready_links(&links);
+  munmap(map, st.st_size);
+  close(fd);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Checks that a record moving a process in or out of a ready queue
+ * only names CPUs, queues and processes the header says there are,
+ * since they index the rebuilt queues.
+ *
+ * @return 1 if the record is in range and 0 otherwise.
+ */
+static int is_queue_record_valid(const struct trace_record* rec,
+                                 const struct trace_header* header) {
+  uint32_t cpu = rec->arg >> 32;
+  uint32_t queue = rec->arg & 0xffffffff;
+  return cpu < header->num_cpus &&
+         (queue < header->num_levels || queue == TR_REALTIME_QUEUE) &&
+         rec->proc_id >= 0 && (uint32_t) rec->proc_id < header->num_procs;
+}
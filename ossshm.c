@@ -1,126 +1,144 @@
 #include <stdlib.h>
 #include <stdio.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "ossshm.h"
 
-/**
- * Allocates shared memory for a simulated clock.
- * 
- * @return The shared memory segment ID
- */
-int get_clock_shm(void) {
-  int id = shmget(IPC_PRIVATE, sizeof(struct my_clock),
-    IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
-
-  if (id == -1) {
-    perror("Failed to get shared memory for clock");
-    exit(EXIT_FAILURE);
-  }
-  return id;
-}
+static uint64_t round_up(uint64_t size, uint64_t multiple);
+static void set_regions(struct oss_shm* shm, void* base);
 
 /**
- * Attaches to the clock shared memory segment.
- * 
- * @return A pointer to the clock in shared memory.
+ * Creates the shared memory arena, zeroed, and maps it.
+ *
+ * @param shm Set to the mapping
+ * @param name Name of the shared memory object, like "/oss.1234",
+ *             or NULL for memory only this process uses
+ * @param num_pcbs Number of process control blocks
+ * @param num_cpus Number of currently scheduled process slots
+ * @param use_huge_pages Whether to ask for transparent huge pages,
+ *                       which cut TLB misses on a large PCB table
  */
-struct my_clock* attach_to_clock_shm(int id) {
-  void* clock_shm = shmat(id, NULL, 0);
-
-  if (*((int*) clock_shm) == -1) {
-    perror("Failed to attach to clock shared memory");
+void create_oss_shm(struct oss_shm* shm, const char* name, int num_pcbs,
+                    int num_cpus, int use_huge_pages) {
+  struct oss_shm_header header;
+  memset(&header, 0, sizeof(header));
+  header.magic = OSS_SHM_MAGIC;
+  header.version = OSS_SHM_VERSION;
+  header.num_cpus = num_cpus;
+  header.num_pcbs = num_pcbs;
+
+  uint64_t offset = round_up(sizeof(header), CACHE_LINE_SIZE);
+  header.clock_offset = offset;
+  offset += round_up(sizeof(struct sim_clock), CACHE_LINE_SIZE);
+  header.curr_sched_offset = offset;
+  offset += round_up(sizeof(struct curr_sched) * num_cpus, CACHE_LINE_SIZE);
+  header.pcb_offset = offset;
+  offset += sizeof(struct pcb) * num_pcbs;
+  header.size = round_up(offset, use_huge_pages ? HUGE_PAGE_SIZE
+                                                : sysconf(_SC_PAGESIZE));
+
+  void* base;
+  if (name == NULL) {
+    base = mmap(NULL, header.size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  } else {
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+      perror("Failed to create shared memory");
+      exit(EXIT_FAILURE);
+    }
+    if (ftruncate(fd, header.size) == -1) {
+      perror("Failed to size shared memory");
+      shm_unlink(name);
+      exit(EXIT_FAILURE);
+    }
+    base = mmap(NULL, header.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+  }
+  if (base == MAP_FAILED) {
+    perror("Failed to map shared memory");
+    if (name != NULL) {
+      shm_unlink(name);
+    }
     exit(EXIT_FAILURE);
   }
+  if (use_huge_pages) {
+    // Only a hint; the kernel may not back shared memory with huge pages
+    madvise(base, header.size, MADV_HUGEPAGE);
+  }
 
-  return (struct my_clock*) clock_shm;
+  memcpy(base, &header, sizeof(header));
+  set_regions(shm, base);
 }
 
 /**
- * Allocates shared memory for multiple process control blocks.
- * 
- * @return The shared memory segment ID
+ * Maps the shared memory arena created by oss.
+ *
+ * @param shm Set to the mapping
+ * @param name Name of the shared memory object
  */
-int get_pcb_shm(int num_blocks) {
-  int segment_size = sizeof(struct pcb) * num_blocks;
-  int id = shmget(IPC_PRIVATE, segment_size,
-    IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
-
-  if (id == -1) {
-    perror("Failed to get shared memory for process control blocks");
+void attach_to_oss_shm(struct oss_shm* shm, const char* name) {
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd == -1) {
+    perror("Failed to open shared memory");
     exit(EXIT_FAILURE);
   }
-  return id;
-}
-
-/**
- * Attaches to the shared memory segment for process control blocks.
- * 
- * @return A pointer to an array of process control blocks in shared memory.
- */
-struct pcb* attach_to_pcb_shm(int id) {
-  void* pcb_shm = shmat(id, NULL, 0);
-
-  if (*((int*) pcb_shm) == -1) {
-    perror("Failed to attach to process control block shared memory");
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    perror("Failed to get the size of shared memory");
+    exit(EXIT_FAILURE);
+  }
+  void* base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    perror("Failed to map shared memory");
     exit(EXIT_FAILURE);
   }
 
-  return (struct pcb*) pcb_shm;
+  struct oss_shm_header* header = base;
+  if ((size_t) st.st_size < sizeof(*header) ||
+      header->magic != OSS_SHM_MAGIC || header->version != OSS_SHM_VERSION ||
+      header->size != (uint64_t) st.st_size) {
+    fprintf(stderr, "Shared memory %s isn't from this version of oss.\n", name);
+    exit(EXIT_FAILURE);
+  }
+  set_regions(shm, base);
 }
 
 /**
- * Allocates shared memory for the currently scheduled process.
- * See curr_sched definition in structs.h
- * 
- * @return The shared memory segment ID
+ * Unmaps the shared memory arena.
  */
-int get_curr_sched_shm(void) {
-  int id = shmget(IPC_PRIVATE, sizeof(struct curr_sched),
-    IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
-
-  if (id == -1) {
-    perror("Failed to get shared memory for currently scheduled process");
-    exit(EXIT_FAILURE);
+void detach_from_oss_shm(struct oss_shm* shm) {
+  if (munmap(shm->header, shm->header->size) == -1) {
+    perror("Failed to unmap shared memory");
   }
-  return id;
 }
 
 /**
- * Attaches to the shared memory segment for the schedule block.
- * 
- * @return A pointer to the schedule block in shared memory.
+ * Removes the shared memory object's name. The memory is freed
+ * once every process has detached.
  */
-struct curr_sched* attach_to_curr_sched_shm(int id) {
-  void* curr_sched_shm = shmat(id, NULL, 0);
-
-  if (*((int*) curr_sched_shm) == -1) {
-    perror("Failed to attach to currently scheduled process shared memory");
-    exit(EXIT_FAILURE);
+void remove_oss_shm(const char* name) {
+  if (shm_unlink(name) == -1) {
+    perror("Failed to remove shared memory");
   }
-
-  return (struct curr_sched*) curr_sched_shm;
 }
 
-void detach_from_clock_shm(struct my_clock* shm) {
-  int return_value = shmdt(shm);
-  if (return_value == -1) {
-    perror("Failed to detach from clock shared memory");
-  }
+static uint64_t round_up(uint64_t size, uint64_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
 }
 
-void detach_from_pcb_shm(struct pcb* shm) {
-  int return_value = shmdt(shm);
-  if (return_value == -1) {
-    perror("Failed to detach from process control block shared memory");
-  }
+/**
+ * Points a mapping at the regions listed in the arena's header.
+ */
+static void set_regions(struct oss_shm* shm, void* base) {
+  char* bytes = base;
+  shm->header = base;
+  shm->clock = (struct sim_clock*) (bytes + shm->header->clock_offset);
+  shm->curr_sched = (struct curr_sched*) (bytes + shm->header->curr_sched_offset);
+  shm->pcbs = (struct pcb*) (bytes + shm->header->pcb_offset);
 }
-
-void detach_from_curr_sched_shm(struct curr_sched* shm) {
-  int return_value = shmdt(shm);
-  if (return_value == -1) {
-    perror("Failed to detach from currnelty scheduled process shared memory");
-  }
-}
\ No newline at end of file
@@ -1,23 +1,75 @@
 #ifndef OSSSHM_H
 #define OSSSHM_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "structs.h"
 #include "myclock.h"
 
 /**
  * Operating System Simulator Shared Memory
+ *
+ * One POSIX shared memory object holds everything oss shares with
+ * its children: a header, the clock, the currently scheduled process
+ * on each CPU and the process control blocks. Each region starts on
+ * a cache line of its own, at an offset given in the header, so a
+ * child attaches with just the object's name.
  */
 
-int get_clock_shm(void);
-struct my_clock* attach_to_clock_shm(int id);
-void detach_from_clock_shm(struct my_clock* shm);
+/*************
+ * CONSTANTS *
+ *************/
 
-int get_pcb_shm(int num_blocks);
-struct pcb* attach_to_pcb_shm(int id);
-void detach_from_pcb_shm(struct pcb* shm);
+#define OSS_SHM_MAGIC 0x4f535353 // "OSSS"
+#define OSS_SHM_VERSION 4        // Bumped whenever the layout changes
 
-int get_curr_sched_shm(void);
-struct curr_sched* attach_to_curr_sched_shm(int id);
-void detach_from_curr_sched_shm(struct curr_sched* shm);
+// Size of a huge page, which the arena is rounded up to with -H
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
-#endif
\ No newline at end of file
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Arena Header
+ * At the start of the shared memory object. Offsets are in bytes
+ * from the start of the object.
+ * --------------------------------------------------------------*/
+struct oss_shm_header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t size;              // Of the whole object
+  uint64_t clock_offset;
+  uint64_t curr_sched_offset; // num_cpus of them
+  uint64_t pcb_offset;        // num_pcbs of them
+  uint32_t num_cpus;
+  uint32_t num_pcbs;
+};
+
+/*
+ * A process's mapping of the arena
+ * --------------------------------*/
+struct oss_shm {
+  struct oss_shm_header* header;
+  struct sim_clock* clock;
+  struct curr_sched* curr_sched;
+  struct pcb* pcbs;
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void create_oss_shm(struct oss_shm* shm, const char* name, int num_pcbs,
+                    int num_cpus, int use_huge_pages);
+void attach_to_oss_shm(struct oss_shm* shm, const char* name);
+void detach_from_oss_shm(struct oss_shm* shm);
+void remove_oss_shm(const char* name);
+
+#endif
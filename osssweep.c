@@ -0,0 +1,376 @@
+/**
+ * Parameter Sweep
+ *
+ * Runs oss once for every combination of the given time quanta,
+ * queue counts, process counts, CPU counts, seeds and policies,
+ * several runs at a time, and writes the metrics of each run's
+ * report as one line of CSV.
+ *
+ * Every run gets a directory of its own for its log and trace.
+ * Each oss names its shared memory object after its process ID,
+ * so runs never share an arena.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_VALUES 64
+
+/*
+ * One swept parameter: the oss option and its values
+ * ---------------------------------------------------*/
+struct param {
+  const char* name;        // CSV column
+  char option;             // oss option
+  char* values[MAX_VALUES];
+  int num_values;
+};
+
+/*
+ * Metrics of one run, read from its report
+ * ----------------------------------------*/
+struct result {
+  int status;              // Exit status of oss, -1 if it didn't exit
+  double wall_secs;
+  long completed;
+  unsigned long events;
+  unsigned long long avg_turnaround;
+  unsigned long long avg_wait;
+  unsigned long long p99_turnaround;
+  unsigned long long p99_wait;
+  double fairness;
+  double total_utilization;
+  int num_cpus;
+  double load_imbalance;
+  unsigned long rt_jobs;
+  unsigned long missed_deadlines;
+};
+
+/*
+ * A run in progress
+ * -----------------*/
+struct run {
+  pid_t pid;
+  int config;
+  struct timespec started_at;
+};
+
+enum { PARAM_QUANTUM, PARAM_LEVELS, PARAM_PROCS, PARAM_CPUS, PARAM_SEED,
+       PARAM_POLICY, NUM_PARAMS };
+
+static struct param params[NUM_PARAMS] = {
+  [PARAM_QUANTUM] = { "quantum", 'Q', { "100000000" }, 1 },
+  [PARAM_LEVELS] = { "levels", 'q', { "3" }, 1 },
+  [PARAM_PROCS] = { "procs", 'n', { "3" }, 1 },
+  [PARAM_CPUS] = { "cpus", 'c', { "1" }, 1 },
+  [PARAM_SEED] = { "seed", 's', { "1" }, 1 },
+  [PARAM_POLICY] = { "policy", 'p', { "mlfq" }, 1 }
+};
+
+static char oss_path[PATH_MAX];
+static char work_dir[PATH_MAX];
+
+static int parse_values(struct param* param, char* list);
+static int get_num_configs(void);
+static const char* get_value(int config, int param);
+static pid_t start_run(int config);
+static void read_report(int config, struct result* result);
+static void write_csv(FILE* out, struct result* results, int num_configs);
+static void get_run_dir(int config, char* path, size_t size);
+static double get_elapsed_secs(struct timespec a, struct timespec b);
+
+int main(int argc, char* argv[]) {
+  long num_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  char* out_file = NULL;
+  char* oss = "./oss";
+  int c, i;
+
+  while ((c = getopt(argc, argv, "j:o:x:Q:q:n:c:s:p:")) != -1) {
+    int param = -1;
+    switch (c) {
+      case 'j':
+        num_jobs = atol(optarg);
+        break;
+      case 'o':
+        out_file = optarg;
+        break;
+      case 'x':
+        oss = optarg;
+        break;
+      default:
+        for (i = 0; i < NUM_PARAMS; i++) {
+          if (params[i].option == c) {
+            param = i;
+          }
+        }
+        if (param == -1) {
+          fprintf(stderr,
+                  "Usage: %s [-j jobs] [-o csv_file] [-x oss] [-Q quanta] [-q levels]\n"
+                  "       [-n procs] [-c cpus] [-s seeds] [-p policies]\n"
+                  "Each parameter is a comma-separated list of values for oss.\n",
+                  argv[0]);
+          return EXIT_FAILURE;
+        }
+        if (parse_values(&params[param], optarg) == -1) {
+          fprintf(stderr, "At most %d values for -%c.\n", MAX_VALUES, c);
+          return EXIT_FAILURE;
+        }
+    }
+  }
+  if (num_jobs < 1) {
+    num_jobs = 1;
+  }
+
+  // Runs happen in their own directories, and oss execs user from its PATH
+  if (realpath(oss, oss_path) == NULL) {
+    perror("Failed to find oss");
+    return EXIT_FAILURE;
+  }
+  char* oss_dir = strdup(oss_path);
+  *strrchr(oss_dir, '/') = '\0';
+  char* old_path = getenv("PATH");
+  char* new_path = malloc(strlen(oss_dir) + (old_path ? strlen(old_path) : 0) + 2);
+  sprintf(new_path, "%s:%s", oss_dir, old_path ? old_path : "");
+  setenv("PATH", new_path, 1);
+
+  strcpy(work_dir, "/tmp/osssweep.XXXXXX");
+  if (mkdtemp(work_dir) == NULL) {
+    perror("Failed to create work directory");
+    return EXIT_FAILURE;
+  }
+
+  FILE* out = stdout;
+  if (out_file != NULL && (out = fopen(out_file, "w")) == NULL) {
+    perror("Failed to open CSV file");
+    return EXIT_FAILURE;
+  }
+
+  int num_configs = get_num_configs();
+  struct result* results = calloc(num_configs, sizeof(struct result));
+  struct run* runs = calloc(num_jobs, sizeof(struct run));
+  if (results == NULL || runs == NULL) {
+    perror("Failed to allocate runs");
+    return EXIT_FAILURE;
+  }
+
+  int next_config = 0;
+  int num_running = 0;
+  while (next_config < num_configs || num_running > 0) {
+    // Keep every job busy
+    while (next_config < num_configs && num_running < num_jobs) {
+      for (i = 0; runs[i].pid != 0; i++);
+      runs[i].config = next_config;
+      clock_gettime(CLOCK_MONOTONIC, &runs[i].started_at);
+      runs[i].pid = start_run(next_config);
+      next_config++;
+      num_running++;
+    }
+
+    int status;
+    pid_t pid = wait(&status);
+    if (pid == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("Failed to wait for oss");
+      return EXIT_FAILURE;
+    }
+    struct timespec ended_at;
+    clock_gettime(CLOCK_MONOTONIC, &ended_at);
+    for (i = 0; i < num_jobs && runs[i].pid != pid; i++);
+    if (i == num_jobs) {
+      continue;
+    }
+
+    struct result* result = &results[runs[i].config];
+    result->status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    result->wall_secs = get_elapsed_secs(runs[i].started_at, ended_at);
+    read_report(runs[i].config, result);
+    fprintf(stderr, "Finished run %d of %d\n", runs[i].config + 1, num_configs);
+    runs[i].pid = 0;
+    num_running--;
+  }
+
+  write_csv(out, results, num_configs);
+  if (out != stdout) {
+    fclose(out);
+  }
+  rmdir(work_dir);
+  free(results);
+  free(runs);
+  free(new_path);
+  free(oss_dir);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Replaces a parameter's values with a comma-separated list.
+ *
+ * @return 0 on success and -1 if there are too many values.
+ */
+static int parse_values(struct param* param, char* list) {
+  param->num_values = 0;
+  char* token = strtok(list, ",");
+  while (token != NULL) {
+    if (param->num_values == MAX_VALUES) {
+      return -1;
+    }
+    param->values[param->num_values++] = token;
+    token = strtok(NULL, ",");
+  }
+  return 0;
+}
+
+static int get_num_configs(void) {
+  int num_configs = 1;
+  int i;
+  for (i = 0; i < NUM_PARAMS; i++) {
+    num_configs *= params[i].num_values;
+  }
+  return num_configs;
+}
+
+/**
+ * Configurations are numbered like a mixed-radix number,
+ * with the last parameter varying fastest.
+ *
+ * @return The value of a parameter in a configuration.
+ */
+static const char* get_value(int config, int param) {
+  int i;
+  for (i = NUM_PARAMS - 1; i > param; i--) {
+    config /= params[i].num_values;
+  }
+  return params[param].values[config % params[param].num_values];
+}
+
+static void get_run_dir(int config, char* path, size_t size) {
+  snprintf(path, size, "%s/%d", work_dir, config);
+}
+
+/**
+ * Starts oss for one configuration in the configuration's own
+ * directory. Only the report goes in the log file; the events go
+ * in a binary trace, which is much cheaper to write.
+ *
+ * @return The process ID of oss.
+ */
+static pid_t start_run(int config) {
+  char dir[PATH_MAX];
+  get_run_dir(config, dir, sizeof(dir));
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    perror("Failed to fork");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    if (mkdir(dir, 0700) == -1 || chdir(dir) == -1) {
+      perror("Failed to create run directory");
+      _exit(EXIT_FAILURE);
+    }
+    char* args[2 * NUM_PARAMS + 4];
+    char options[NUM_PARAMS][3];
+    int num_args = 0;
+    int i;
+    args[num_args++] = "oss";
+    for (i = 0; i < NUM_PARAMS; i++) {
+      sprintf(options[i], "-%c", params[i].option);
+      args[num_args++] = options[i];
+      args[num_args++] = (char*) get_value(config, i);
+    }
+    args[num_args++] = "-t";
+    args[num_args++] = "oss.trace";
+    args[num_args] = NULL;
+    execv(oss_path, args);
+    perror("Failed to exec oss");
+    _exit(EXIT_FAILURE);
+  }
+  return pid;
+}
+
+/**
+ * Reads the metrics of a finished run from its report,
+ * then removes the run's directory.
+ */
+static void read_report(int config, struct result* result) {
+  char dir[PATH_MAX];
+  char path[PATH_MAX + 16];
+  get_run_dir(config, dir, sizeof(dir));
+
+  snprintf(path, sizeof(path), "%s/oss.out", dir);
+  FILE* fp = fopen(path, "r");
+  if (fp != NULL) {
+    char line[512];
+    unsigned int secs, nanosecs, unused;
+    double utilization;
+    int cpu;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+      if (sscanf(line, "Processes Completed: %ld", &result->completed) == 1 ||
+          sscanf(line, "Events Handled: %lu", &result->events) == 1) {
+        continue;
+      }
+      if (sscanf(line, "Average Turnaround Time: %u:%u", &secs, &nanosecs) == 2) {
+        result->avg_turnaround = secs * 1000000000ULL + nanosecs;
+      } else if (sscanf(line, "Average Wait Time: %u:%u", &secs, &nanosecs) == 2) {
+        result->avg_wait = secs * 1000000000ULL + nanosecs;
+      } else if (sscanf(line, "Turnaround Time: p50 %u:%u, p90 %u:%u, p99 %u:%u",
+                        &unused, &unused, &unused, &unused, &secs, &nanosecs) == 6) {
+        result->p99_turnaround = secs * 1000000000ULL + nanosecs;
+      } else if (sscanf(line, "Ready Queue Wait Time: p50 %u:%u, p90 %u:%u, p99 %u:%u",
+                        &unused, &unused, &unused, &unused, &secs, &nanosecs) == 6) {
+        result->p99_wait = secs * 1000000000ULL + nanosecs;
+      } else if (sscanf(line, "Fairness (Jain's index of CPU share): %lf",
+                        &result->fairness) == 1) {
+        continue;
+      } else if (sscanf(line, "CPU %d: Utilization %lf", &cpu, &utilization) == 2) {
+        result->total_utilization += utilization;
+        result->num_cpus++;
+      } else if (sscanf(line, "Load Imbalance (busiest CPU / average): %lf",
+                        &result->load_imbalance) == 1) {
+        continue;
+      } else {
+        sscanf(line, "Real-Time Jobs: %lu, Missed Deadlines %lu",
+               &result->rt_jobs, &result->missed_deadlines);
+      }
+    }
+    fclose(fp);
+    unlink(path);
+  }
+
+  snprintf(path, sizeof(path), "%s/oss.trace", dir);
+  unlink(path);
+  rmdir(dir);
+}
+
+static void write_csv(FILE* out, struct result* results, int num_configs) {
+  int i, j;
+  for (i = 0; i < NUM_PARAMS; i++) {
+    fprintf(out, "%s,", params[i].name);
+  }
+  fprintf(out, "status,wall_secs,completed,events,avg_turnaround_ns,avg_wait_ns,"
+               "p99_turnaround_ns,p99_wait_ns,"
+               "fairness,avg_utilization,load_imbalance,rt_jobs,missed_deadlines\n");
+  for (i = 0; i < num_configs; i++) {
+    struct result* r = &results[i];
+    for (j = 0; j < NUM_PARAMS; j++) {
+      fprintf(out, "%s,", get_value(i, j));
+    }
+    fprintf(out, "%d,%.3f,%ld,%lu,%llu,%llu,%llu,%llu,%.4f,%.2f,%.2f,%lu,%lu\n",
+            r->status, r->wall_secs, r->completed, r->events, r->avg_turnaround,
+            r->avg_wait, r->p99_turnaround, r->p99_wait, r->fairness,
+            r->num_cpus > 0 ? r->total_utilization / r->num_cpus : 0.0,
+            r->load_imbalance, r->rt_jobs, r->missed_deadlines);
+  }
+}
+
+static double get_elapsed_secs(struct timespec a, struct timespec b) {
+  return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
+}
@@ -0,0 +1,217 @@
+/**
+ * Workload Converter
+ *
+ * Converts a workload from CSV to the binary format oss replays
+ * with -w, see workload.h. Every line is one burst of a process:
+ *
+ *   proc,arrival,class,cpu_time,io_wait
+ *
+ * proc names the process, arrival is when it arrives after the
+ * start of the run, class is interactive, normal or batch, cpu_time
+ * is the CPU time the burst needs and io_wait is how long the
+ * process then waits for I/O. Times are in nanoseconds. The bursts
+ * of a process are on consecutive lines, in the order they run,
+ * and processes are in order of arrival. A first line that isn't
+ * a burst, like a header, and lines starting with # are skipped.
+ *
+ * Only the current line is kept in memory, so a workload of any
+ * length converts in constant memory.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include "workload.h"
+
+#define MAX_LINE 1024
+#define NUM_FIELDS 5
+
+/*
+ * One line of the CSV file
+ * ------------------------*/
+struct csv_burst {
+  char* proc;
+  uint64_t arrival;
+  int proc_class;
+  uint64_t cpu_time;
+  uint64_t io_wait;
+};
+
+static int parse_burst(char* line, struct csv_burst* burst);
+static int parse_time(const char* field, uint64_t* time);
+static void write_or_exit(FILE* fp, const void* data, size_t size, long offset);
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "Usage: %s csv_file workload_file\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  FILE* in = fopen(argv[1], "r");
+  if (in == NULL) {
+    perror("Failed to open CSV file");
+    return EXIT_FAILURE;
+  }
+  FILE* out = fopen(argv[2], "wb");
+  if (out == NULL) {
+    perror("Failed to open workload file");
+    return EXIT_FAILURE;
+  }
+
+  struct workload_header header;
+  memset(&header, 0, sizeof(header));
+  header.magic = WORKLOAD_MAGIC;
+  header.version = WORKLOAD_VERSION;
+  write_or_exit(out, &header, sizeof(header), -1);
+
+  // The process being written. Its record is rewritten
+  // with the number of bursts once they're all written.
+  char curr_proc[MAX_LINE] = "";
+  struct workload_proc proc;
+  long proc_offset = -1;
+
+  char line[MAX_LINE];
+  long line_num = 0;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    line_num++;
+    size_t length = strcspn(line, "\r\n");
+    if (line[length] == '\0' && !feof(in)) {
+      fprintf(stderr, "%s:%ld: Line is too long.\n", argv[1], line_num);
+      return EXIT_FAILURE;
+    }
+    line[length] = '\0';
+    if (line[0] == '#' || line[0] == '\0') {
+      continue;
+    }
+
+    struct csv_burst burst;
+    if (parse_burst(line, &burst) == -1) {
+      if (line_num == 1) {
+        continue; // A header
+      }
+      fprintf(stderr, "%s:%ld: Expected proc,arrival,class,cpu_time,io_wait "
+              "with times in nanoseconds and class interactive, normal or batch.\n",
+              argv[1], line_num);
+      return EXIT_FAILURE;
+    }
+    if (burst.cpu_time > UINT32_MAX ||
+        (burst.io_wait + 999) / 1000 > UINT32_MAX) {
+      fprintf(stderr, "%s:%ld: Burst is too long.\n", argv[1], line_num);
+      return EXIT_FAILURE;
+    }
+
+    if (proc_offset == -1 || strcmp(burst.proc, curr_proc) != 0) {
+      if (proc_offset != -1) {
+        if (burst.arrival < proc.arrival) {
+          fprintf(stderr, "%s:%ld: Process %s arrives before process %s.\n",
+                  argv[1], line_num, burst.proc, curr_proc);
+          return EXIT_FAILURE;
+        }
+        write_or_exit(out, &proc, sizeof(proc), proc_offset);
+      }
+      strcpy(curr_proc, burst.proc);
+      proc.arrival = burst.arrival;
+      proc.num_bursts = 0;
+      proc.proc_class = burst.proc_class;
+      proc_offset = ftell(out);
+      write_or_exit(out, &proc, sizeof(proc), -1);
+      header.num_procs++;
+    } else if (burst.arrival != proc.arrival ||
+               burst.proc_class != proc.proc_class) {
+      fprintf(stderr, "%s:%ld: Process %s has another arrival or class.\n",
+              argv[1], line_num, burst.proc);
+      return EXIT_FAILURE;
+    } else if (proc.num_bursts == UINT32_MAX) {
+      fprintf(stderr, "%s:%ld: Process %s has too many bursts.\n",
+              argv[1], line_num, burst.proc);
+      return EXIT_FAILURE;
+    }
+
+    struct workload_burst rec;
+    rec.cpu_time = burst.cpu_time;
+    rec.io_wait = (burst.io_wait + 999) / 1000; // A wait never rounds to none
+    write_or_exit(out, &rec, sizeof(rec), -1);
+    proc.num_bursts++;
+    header.num_bursts++;
+  }
+  if (ferror(in)) {
+    perror("Failed to read CSV file");
+    return EXIT_FAILURE;
+  }
+
+  if (proc_offset == -1) {
+    fprintf(stderr, "%s has no bursts.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  write_or_exit(out, &proc, sizeof(proc), proc_offset);
+  write_or_exit(out, &header, sizeof(header), 0);
+  if (fclose(out) == EOF) {
+    perror("Failed to write workload file");
+    return EXIT_FAILURE;
+  }
+  fclose(in);
+
+  printf("%llu processes, %llu bursts\n", (unsigned long long) header.num_procs,
+         (unsigned long long) header.num_bursts);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Splits a line of the CSV file into its fields.
+ *
+ * @param line The line, which is modified
+ * @param burst Where to store the fields
+ * @return 0 on success and -1 if the line isn't a burst.
+ */
+static int parse_burst(char* line, struct csv_burst* burst) {
+  char* fields[NUM_FIELDS];
+  int i;
+  for (i = 0; i < NUM_FIELDS; i++) {
+    fields[i] = line;
+    line = strchr(line, ',');
+    if (line == NULL) {
+      break;
+    }
+    *line++ = '\0';
+  }
+  if (i != NUM_FIELDS - 1 || fields[0][0] == '\0') {
+    return -1;
+  }
+
+  burst->proc = fields[0];
+  burst->proc_class = get_proc_class_by_name(fields[2]);
+  if (burst->proc_class == -1 ||
+      parse_time(fields[1], &burst->arrival) == -1 ||
+      parse_time(fields[3], &burst->cpu_time) == -1 ||
+      parse_time(fields[4], &burst->io_wait) == -1) {
+    return -1;
+  }
+  return 0;
+}
+
+static int parse_time(const char* field, uint64_t* time) {
+  char* end;
+  errno = 0;
+  *time = strtoull(field, &end, 10);
+  if (*field < '0' || *field > '9' || *end != '\0' || errno == ERANGE) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Writes to the workload file, exiting if it can't.
+ *
+ * @param offset Where to write, after which the file goes back to
+ *               its end, or -1 to append
+ */
+static void write_or_exit(FILE* fp, const void* data, size_t size, long offset) {
+  if ((offset != -1 && fseek(fp, offset, SEEK_SET) == -1) ||
+      fwrite(data, size, 1, fp) != 1 ||
+      (offset != -1 && fseek(fp, 0, SEEK_END) == -1)) {
+    perror("Failed to write workload file");
+    exit(EXIT_FAILURE);
+  }
+}
@@ -0,0 +1,34 @@
+#include <string.h>
+#include "policy.h"
+
+static const char* policy_names[] = {
+  [POLICY_MLFQ] = "mlfq",
+  [POLICY_CFS] = "cfs",
+  [POLICY_SRTF] = "srtf",
+  [POLICY_LOTTERY] = "lottery",
+  [POLICY_STRIDE] = "stride",
+  [POLICY_FIFO] = "fifo"
+};
+
+#define NUM_POLICIES (sizeof(policy_names) / sizeof(policy_names[0]))
+
+/**
+ * @return The policy with that name, or -1 if there isn't one.
+ */
+int get_policy_by_name(const char* name) {
+  unsigned int i;
+  for (i = 0; i < NUM_POLICIES; i++) {
+    if (strcmp(name, policy_names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @return 1 if the policy keeps ready processes in the numbered
+ *         queues of a feedback queue, which the log prints.
+ */
+int policy_has_levels(int policy) {
+  return policy == POLICY_MLFQ || policy == POLICY_FIFO;
+}
@@ -0,0 +1,34 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+/**
+ * Scheduling Policies
+ *
+ * oss schedules the ready processes of every CPU with one policy,
+ * chosen with -p. See sched.h for what a policy implements.
+ */
+
+/**************
+ * STRUCTURES *
+ **************/
+
+enum sched_policy {
+  POLICY_MLFQ,  // Multi-level feedback queue, see mlfq.h
+  POLICY_CFS,   // Completely fair scheduler, see cfs.h
+  POLICY_SRTF,  // Shortest remaining time first, see srtf.h
+  POLICY_LOTTERY, // Lottery scheduling, see lottery.h
+  POLICY_STRIDE,  // Stride scheduling, see lottery.h
+  POLICY_FIFO     // Round robin in a single first-in first-out queue
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+int get_policy_by_name(const char* name);
+int policy_has_levels(int policy);
+
+#endif
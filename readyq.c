@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "readyq.h"
+
+/**
+ * Allocates the links for processes 0 through capacity - 1.
+ * This is the only allocation; queue operations never allocate.
+ */
+void init_ready_links(struct ready_links* links, int capacity) {
+  links->next = malloc(sizeof(int) * capacity);
+  links->prev = malloc(sizeof(int) * capacity);
+  if (links->next == NULL || links->prev == NULL) {
+    perror("Failed to allocate ready queue links");
+    exit(EXIT_FAILURE);
+  }
+  links->capacity = capacity;
+}
+
+void free_ready_links(struct ready_links* links) {
+  free(links->next);
+  free(links->prev);
+  links->next = NULL;
+  links->prev = NULL;
+  links->capacity = 0;
+}
+
+void init_ready_queue(struct ready_queue* q) {
+  q->head = -1;
+  q->tail = -1;
+  q->length = 0;
+}
+
+/**
+ * Puts a process at the back of a queue.
+ *
+ * @param q The queue
+ * @param links Links shared by every queue the process can be in
+ * @param proc_id The process, which must not already be in a queue
+ */
+void ready_queue_push(struct ready_queue* q, struct ready_links* links,
+                      int proc_id) {
+  links->next[proc_id] = -1;
+  links->prev[proc_id] = q->tail;
+  if (q->tail == -1) {
+    q->head = proc_id;
+  } else {
+    links->next[q->tail] = proc_id;
+  }
+  q->tail = proc_id;
+  q->length++;
+}
+
+/**
+ * Removes the process at the front of a queue.
+ *
+ * @return The process ID. -1 if the queue is empty.
+ */
+int ready_queue_pop(struct ready_queue* q, struct ready_links* links) {
+  int proc_id = q->head;
+  if (proc_id != -1) {
+    ready_queue_remove(q, links, proc_id);
+  }
+  return proc_id;
+}
+
+/**
+ * Removes a process from anywhere in a queue.
+ *
+ * @param proc_id The process, which must be in q
+ */
+void ready_queue_remove(struct ready_queue* q, struct ready_links* links,
+                        int proc_id) {
+  int next = links->next[proc_id];
+  int prev = links->prev[proc_id];
+  if (prev == -1) {
+    q->head = next;
+  } else {
+    links->next[prev] = next;
+  }
+  if (next == -1) {
+    q->tail = prev;
+  } else {
+    links->prev[next] = prev;
+  }
+  q->length--;
+}
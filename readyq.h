@@ -0,0 +1,51 @@
+#ifndef READYQ_H
+#define READYQ_H
+
+/**
+ * Allocation-free Ready Queues
+ *
+ * A process is in at most one ready queue at a time, so the links
+ * are stored in arrays indexed by process ID and shared by every
+ * queue. Queues themselves are just a head, a tail and a length.
+ */
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Intrusive Links
+ * Indexed by process ID. -1 marks the end of a queue.
+ * ---------------------------------------------------*/
+struct ready_links {
+  int* next;
+  int* prev;
+  int capacity;
+};
+
+/*
+ * FIFO Ready Queue
+ * ----------------*/
+struct ready_queue {
+  int head;
+  int tail;
+  unsigned int length;
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_ready_links(struct ready_links* links, int capacity);
+void free_ready_links(struct ready_links* links);
+void init_ready_queue(struct ready_queue* q);
+void ready_queue_push(struct ready_queue* q, struct ready_links* links,
+                      int proc_id);
+int ready_queue_pop(struct ready_queue* q, struct ready_links* links);
+void ready_queue_remove(struct ready_queue* q, struct ready_links* links,
+                        int proc_id);
+
+#endif
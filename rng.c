@@ -0,0 +1,60 @@
+#include "rng.h"
+
+static uint64_t splitmix64(uint64_t* x);
+static uint64_t rotl(uint64_t x, int k);
+
+/**
+ * Seeds a stream. Different streams of the same seed, and the same
+ * stream of different seeds, start from unrelated states.
+ *
+ * @param r The generator
+ * @param seed The run's seed, see -s
+ * @param stream Which stream of the run, see RNG_STREAM_*
+ */
+void rng_seed(struct rng* r, uint64_t seed, uint64_t stream) {
+  uint64_t x = stream;
+  uint64_t y = seed ^ splitmix64(&x);
+  int i;
+  for (i = 0; i < 4; i++) {
+    r->s[i] = splitmix64(&y);
+  }
+}
+
+/**
+ * @return The next 64 random bits of a stream.
+ */
+uint64_t rng_next(struct rng* r) {
+  uint64_t* s = r->s;
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+/**
+ * Draws a number in [0, n) without division, by taking the high
+ * half of a 32 by 32 bit product. The bias is at most n / 2^32.
+ *
+ * @param r The generator
+ * @param n The number of possible results, at least 1
+ * @return The number
+ */
+uint32_t rng_below(struct rng* r, uint32_t n) {
+  return (uint32_t) (((rng_next(r) >> 32) * n) >> 32);
+}
+
+static uint64_t splitmix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
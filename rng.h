@@ -0,0 +1,47 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * Seedable Random Number Streams
+ *
+ * xoshiro256** generators, each seeded from a run's seed and a
+ * stream number by splitmix64. oss and every simulated process
+ * draw from their own stream, so a run depends only on its seed,
+ * not on when the processes were started.
+ */
+
+/*************
+ * CONSTANTS *
+ *************/
+
+// Stream numbers; a process's stream also depends on its slot's generation
+#define RNG_STREAM_OSS 0
+#define RNG_STREAM_CPU(cpu) ((1ULL << 62) | (uint64_t) (cpu))
+#define RNG_STREAM_PROC(proc_id, generation) \
+  ((1ULL << 63) | (uint64_t) (generation) << 32 | (uint32_t) (proc_id))
+
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct rng {
+  uint64_t s[4];
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void rng_seed(struct rng* r, uint64_t seed, uint64_t stream);
+uint64_t rng_next(struct rng* r);
+uint32_t rng_below(struct rng* r, uint32_t n);
+
+#endif
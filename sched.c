@@ -0,0 +1,269 @@
+#include "sched.h"
+#include "policy.h"
+#include "srtf.h"
+
+/*
+ * Multi-level Feedback Queue, and first-in first-out as
+ * a feedback queue with a single level.
+ * ------------------------------------------------------*/
+static void mlfq_init(struct cpu* cpu, int num_levels, int num_procs) {
+  init_mlfq(&cpu->mlfq, num_levels, num_procs, cpu->quantum);
+}
+
+static void fifo_init(struct cpu* cpu, int num_levels, int num_procs) {
+  init_mlfq(&cpu->mlfq, 1, num_procs, cpu->quantum);
+}
+
+static void mlfq_teardown(struct cpu* cpu) {
+  free_mlfq(&cpu->mlfq);
+}
+
+static void mlfq_ops_enqueue(struct cpu* cpu, int proc_id, struct pcb* pcb,
+                             uint64_t now) {
+  mlfq_enqueue(&cpu->mlfq, proc_id, pcb->priority, now);
+}
+
+static int mlfq_pick_next(struct cpu* cpu, struct pcb* pcbs, int* priority,
+                          uint64_t now, uint64_t* wait) {
+  return mlfq_dequeue(&cpu->mlfq, priority, now, wait);
+}
+
+static unsigned int mlfq_get_time_quantum(struct cpu* cpu, struct pcb* pcb,
+                                          int priority) {
+  return mlfq_get_quantum(&cpu->mlfq, priority);
+}
+
+/**
+ * Moves the process to another level according to the
+ * feedback rules in mlfq_get_next_level().
+ */
+static int mlfq_on_burst_complete(struct cpu* cpu, struct pcb* pcb) {
+  return mlfq_get_next_level(&cpu->mlfq, pcb->priority, pcb->last_burst_time,
+                             pcb->last_wait_time);
+}
+
+static int fifo_on_burst_complete(struct cpu* cpu, struct pcb* pcb) {
+  return 0;
+}
+
+/*
+ * Completely Fair Scheduler
+ * -------------------------*/
+static void cfs_init(struct cpu* cpu, int num_levels, int num_procs) {
+  init_cfs_rq(&cpu->cfs, num_procs);
+}
+
+static void cfs_teardown(struct cpu* cpu) {
+  free_cfs_rq(&cpu->cfs);
+}
+
+static void cfs_on_create(struct cpu* cpu, struct pcb* pcb) {
+  pcb->weight = NICE_0_WEIGHT;
+}
+
+static void cfs_ops_enqueue(struct cpu* cpu, int proc_id, struct pcb* pcb,
+                            uint64_t now) {
+  pcb->vruntime = cfs_enqueue(&cpu->cfs, proc_id, pcb->vruntime, pcb->weight,
+                              now);
+}
+
+static int cfs_pick_next(struct cpu* cpu, struct pcb* pcbs, int* priority,
+                         uint64_t now, uint64_t* wait) {
+  *priority = 0;
+  return cfs_dequeue(&cpu->cfs, now, wait);
+}
+
+static unsigned int cfs_get_time_quantum(struct cpu* cpu, struct pcb* pcb,
+                                         int priority) {
+  return cfs_get_timeslice(&cpu->cfs, pcb->weight);
+}
+
+/**
+ * Charges the burst to the process's virtual runtime.
+ */
+static int cfs_on_burst_complete(struct cpu* cpu, struct pcb* pcb) {
+  pcb->vruntime = cfs_get_next_vruntime(pcb->vruntime, pcb->last_burst_time,
+                                        pcb->weight);
+  return pcb->priority;
+}
+
+/**
+ * Keeps the process's lead or lag relative to the
+ * CPUs' minimum virtual runtimes.
+ */
+static void cfs_migrate(struct cpu* from, struct cpu* to, struct pcb* pcb) {
+  pcb->vruntime = to->cfs.min_vruntime +
+    subtract_times(pcb->vruntime, from->cfs.min_vruntime);
+}
+
+/*
+ * Shortest Remaining Time First and Stride Scheduling,
+ * both on a heap run queue
+ * ----------------------------------------------------*/
+static void heap_init(struct cpu* cpu, int num_levels, int num_procs) {
+  init_heap_rq(&cpu->heap, num_procs);
+}
+
+static void heap_teardown(struct cpu* cpu) {
+  free_heap_rq(&cpu->heap);
+}
+
+static void srtf_on_create(struct cpu* cpu, struct pcb* pcb) {
+  pcb->predicted_burst = SRTF_INITIAL_PREDICTION;
+}
+
+static void srtf_enqueue(struct cpu* cpu, int proc_id, struct pcb* pcb,
+                         uint64_t now) {
+  // What's left of an interrupted burst is known exactly
+  uint64_t key = pcb->was_interrupted ? pcb->remaining_time
+                                      : pcb->predicted_burst;
+  heap_rq_enqueue(&cpu->heap, proc_id, key, now);
+}
+
+static int srtf_pick_next(struct cpu* cpu, struct pcb* pcbs, int* priority,
+                          uint64_t now, uint64_t* wait) {
+  *priority = 0;
+  return heap_rq_dequeue(&cpu->heap, now, wait);
+}
+
+/**
+ * A fixed quantum; the policy decides who gets it.
+ */
+static unsigned int fixed_get_time_quantum(struct cpu* cpu, struct pcb* pcb,
+                                           int priority) {
+  return cpu->quantum;
+}
+
+static int srtf_on_burst_complete(struct cpu* cpu, struct pcb* pcb) {
+  // An interrupted burst isn't over, so it says little about the next one
+  if (!pcb->was_interrupted) {
+    pcb->predicted_burst = srtf_get_next_prediction(pcb->predicted_burst,
+                                                    pcb->last_burst_time);
+  }
+  return pcb->priority;
+}
+
+/**
+ * Preempts when the new process is expected to finish
+ * before the rest of the running burst.
+ */
+static int srtf_check_preempt(struct cpu* cpu, int proc_id, uint64_t left) {
+  return left > cpu->heap.key[proc_id];
+}
+
+static void stride_enqueue(struct cpu* cpu, int proc_id, struct pcb* pcb,
+                           uint64_t now) {
+  // Like CFS, a new or woken process starts at the global pass
+  pcb->pass = max_time(pcb->pass, cpu->global_pass);
+  heap_rq_enqueue(&cpu->heap, proc_id, pcb->pass, now);
+}
+
+static int stride_pick_next(struct cpu* cpu, struct pcb* pcbs, int* priority,
+                            uint64_t now, uint64_t* wait) {
+  *priority = 0;
+  int proc_id = heap_rq_dequeue(&cpu->heap, now, wait);
+  if (proc_id != -1) {
+    cpu->global_pass = max_time(cpu->global_pass, pcbs[proc_id].pass);
+  }
+  return proc_id;
+}
+
+static int stride_on_burst_complete(struct cpu* cpu, struct pcb* pcb) {
+  pcb->pass = stride_get_next_pass(pcb->pass, pcb->tickets,
+                                   pcb->last_burst_time, cpu->quantum);
+  return pcb->priority;
+}
+
+static void stride_migrate(struct cpu* from, struct cpu* to, struct pcb* pcb) {
+  pcb->pass = to->global_pass + subtract_times(pcb->pass, from->global_pass);
+}
+
+/*
+ * Lottery Scheduling
+ * ------------------*/
+static void lottery_init(struct cpu* cpu, int num_levels, int num_procs) {
+  init_lottery_rq(&cpu->lottery, num_procs);
+}
+
+static void lottery_teardown(struct cpu* cpu) {
+  free_lottery_rq(&cpu->lottery);
+}
+
+static void lottery_ops_enqueue(struct cpu* cpu, int proc_id, struct pcb* pcb,
+                                uint64_t now) {
+  lottery_enqueue(&cpu->lottery, proc_id, pcb->tickets, now);
+}
+
+static int lottery_pick_next(struct cpu* cpu, struct pcb* pcbs, int* priority,
+                             uint64_t now, uint64_t* wait) {
+  *priority = 0;
+  return lottery_dequeue(&cpu->lottery, rng_next(&cpu->rng), now, wait);
+}
+
+static int lottery_on_burst_complete(struct cpu* cpu, struct pcb* pcb) {
+  return pcb->priority;
+}
+
+static const struct sched_ops policy_ops[] = {
+  [POLICY_MLFQ] = {
+    .init = mlfq_init,
+    .teardown = mlfq_teardown,
+    .enqueue = mlfq_ops_enqueue,
+    .pick_next = mlfq_pick_next,
+    .get_time_quantum = mlfq_get_time_quantum,
+    .on_burst_complete = mlfq_on_burst_complete
+  },
+  [POLICY_CFS] = {
+    .init = cfs_init,
+    .teardown = cfs_teardown,
+    .on_create = cfs_on_create,
+    .enqueue = cfs_ops_enqueue,
+    .pick_next = cfs_pick_next,
+    .get_time_quantum = cfs_get_time_quantum,
+    .on_burst_complete = cfs_on_burst_complete,
+    .migrate = cfs_migrate
+  },
+  [POLICY_SRTF] = {
+    .init = heap_init,
+    .teardown = heap_teardown,
+    .on_create = srtf_on_create,
+    .enqueue = srtf_enqueue,
+    .pick_next = srtf_pick_next,
+    .get_time_quantum = fixed_get_time_quantum,
+    .on_burst_complete = srtf_on_burst_complete,
+    .check_preempt = srtf_check_preempt
+  },
+  [POLICY_LOTTERY] = {
+    .init = lottery_init,
+    .teardown = lottery_teardown,
+    .enqueue = lottery_ops_enqueue,
+    .pick_next = lottery_pick_next,
+    .get_time_quantum = fixed_get_time_quantum,
+    .on_burst_complete = lottery_on_burst_complete
+  },
+  [POLICY_STRIDE] = {
+    .init = heap_init,
+    .teardown = heap_teardown,
+    .enqueue = stride_enqueue,
+    .pick_next = stride_pick_next,
+    .get_time_quantum = fixed_get_time_quantum,
+    .on_burst_complete = stride_on_burst_complete,
+    .migrate = stride_migrate
+  },
+  [POLICY_FIFO] = {
+    .init = fifo_init,
+    .teardown = mlfq_teardown,
+    .enqueue = mlfq_ops_enqueue,
+    .pick_next = mlfq_pick_next,
+    .get_time_quantum = mlfq_get_time_quantum,
+    .on_burst_complete = fifo_on_burst_complete
+  }
+};
+
+/**
+ * @param policy See enum sched_policy
+ * @return The policy's operations.
+ */
+const struct sched_ops* get_sched_ops(int policy) {
+  return &policy_ops[policy];
+}
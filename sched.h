@@ -0,0 +1,93 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "structs.h"
+#include "mlfq.h"
+#include "cfs.h"
+#include "heaprq.h"
+#include "lottery.h"
+#include "rng.h"
+
+/**
+ * Scheduling Policy Interface
+ *
+ * Every policy, see policy.h, is a table of operations on a CPU's
+ * run queue. oss only calls through the table, so a new policy is
+ * a new table in sched.c and a name in policy.c.
+ *
+ * Real-time processes are scheduled by oss itself, ahead of the
+ * policy, and never reach these operations.
+ */
+
+/**************
+ * STRUCTURES *
+ **************/
+
+/*
+ * Simulated CPU
+ * Each CPU has its own ready queues and runs one process at a time.
+ * -----------------------------------------------------------------*/
+struct cpu {
+  struct my_mlfq mlfq;        // Ready processes under POLICY_MLFQ and POLICY_FIFO
+  struct cfs_rq cfs;          // Ready processes under POLICY_CFS
+  struct heap_rq heap;        // Ready processes under POLICY_SRTF and POLICY_STRIDE
+  struct lottery_rq lottery;  // Ready processes under POLICY_LOTTERY
+  struct heap_rq edf;         // Ready real-time processes by deadline, ahead of the rest
+  unsigned int quantum;       // Time quantum of the top queue (in nanoseconds), see -Q
+  int running_proc_id;        // -1 while the CPU is idle
+  int num_queued;             // Number of processes in the ready queues
+  uint64_t busy_time;         // Time spent running bursts (in nanoseconds)
+  unsigned long num_bursts;
+  unsigned long num_steals;   // Processes taken from other CPUs' queues
+  unsigned long burst_event_seq; // Event that ends the running burst
+  uint64_t global_pass;       // Pass of the last process dispatched under POLICY_STRIDE
+  struct rng rng;             // Draws of POLICY_LOTTERY
+};
+
+/*
+ * Scheduling Policy Operations
+ * on_create, check_preempt and migrate may be NULL.
+ * -------------------------------------------------*/
+struct sched_ops {
+  // Sets up a CPU's run queue for num_procs process IDs, and frees it
+  void (*init)(struct cpu* cpu, int num_levels, int num_procs);
+  void (*teardown)(struct cpu* cpu);
+
+  // Sets a new process's fields the policy keeps in its PCB
+  // to their starting values
+  void (*on_create)(struct cpu* cpu, struct pcb* pcb);
+
+  // Adds a ready process to the run queue
+  void (*enqueue)(struct cpu* cpu, int proc_id, struct pcb* pcb, uint64_t now);
+
+  // Takes the process to run next, storing the queue it came from
+  // and how long it waited. Returns -1 if the run queue is empty.
+  int (*pick_next)(struct cpu* cpu, struct pcb* pcbs, int* priority,
+                   uint64_t now, uint64_t* wait);
+
+  // How long a process just picked may run for (in nanoseconds)
+  unsigned int (*get_time_quantum)(struct cpu* cpu, struct pcb* pcb,
+                                   int priority);
+
+  // Charges a finished burst to a process, returning the queue
+  // it goes back into
+  int (*on_burst_complete)(struct cpu* cpu, struct pcb* pcb);
+
+  // Whether a process that just became ready should take the CPU
+  // from a process with left nanoseconds of its burst to go
+  int (*check_preempt)(struct cpu* cpu, int proc_id, uint64_t left);
+
+  // Carries a process's position over when another CPU steals it
+  void (*migrate)(struct cpu* from, struct cpu* to, struct pcb* pcb);
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+const struct sched_ops* get_sched_ops(int policy);
+
+#endif
@@ -31,8 +31,9 @@ int sem_wait(int sem_id) {
   operations[0].sem_num = 0;
   /* Decrement by 1. */
   operations[0].sem_op = -1;
-  /* Permit undo'ing. */
-  operations[0].sem_flg = SEM_UNDO;
+  /* No SEM_UNDO: the semaphore signals between processes,
+     so an exiting process must not take back its posts. */
+  operations[0].sem_flg = 0;
   return semop(sem_id, operations, 1);
 }
 
@@ -49,7 +50,7 @@ int sem_post(int sem_id) {
   operations[0].sem_num = 0;
   /* Increment by 1. */
   operations[0].sem_op = 1;
-  /* Permit undo'ing. */
-  operations[0].sem_flg = SEM_UNDO;
+  /* No SEM_UNDO, see sem_wait(). */
+  operations[0].sem_flg = 0;
   return semop(sem_id, operations, 1);
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "slots.h"
+
+#define BITS_PER_WORD 64
+
+void init_slot_table(struct slot_table* t, int num_slots) {
+  t->num_slots = num_slots;
+  t->num_words = (num_slots + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  t->first_free_word = 0;
+  t->num_used = 0;
+  t->used = calloc(t->num_words, sizeof(unsigned long long));
+  if (t->used == NULL) {
+    perror("Failed to allocate process table bit vector");
+    exit(EXIT_FAILURE);
+  }
+
+  // Mark the bits past the last slot as taken so they're never handed out
+  int extra_bits = t->num_words * BITS_PER_WORD - num_slots;
+  if (extra_bits > 0) {
+    t->used[t->num_words - 1] = ~0ULL << (BITS_PER_WORD - extra_bits);
+  }
+}
+
+void free_slot_table(struct slot_table* t) {
+  free(t->used);
+  t->used = NULL;
+}
+
+/**
+ * Takes the lowest free slot with a find-first-zero on each word.
+ *
+ * @return The slot. -1 if every slot is taken.
+ */
+int allocate_slot(struct slot_table* t) {
+  int w;
+  for (w = t->first_free_word; w < t->num_words; w++) {
+    if (t->used[w] != ~0ULL) {
+      int bit = __builtin_ctzll(~t->used[w]);
+      t->used[w] |= 1ULL << bit;
+      t->first_free_word = w;
+      t->num_used++;
+      return w * BITS_PER_WORD + bit;
+    }
+  }
+  t->first_free_word = t->num_words;
+  return -1;
+}
+
+void release_slot(struct slot_table* t, int slot) {
+  int w = slot / BITS_PER_WORD;
+  t->used[w] &= ~(1ULL << (slot % BITS_PER_WORD));
+  if (w < t->first_free_word) {
+    t->first_free_word = w;
+  }
+  t->num_used--;
+}
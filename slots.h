@@ -0,0 +1,35 @@
+#ifndef SLOTS_H
+#define SLOTS_H
+
+/**
+ * Process Table Slot Allocator
+ *
+ * A bit vector, local to oss, that keeps track of the process
+ * control blocks that are already taken.
+ */
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct slot_table {
+  int num_slots;
+  int num_words;
+  int first_free_word;      // No word before this one has a free slot
+  int num_used;
+  unsigned long long* used; // Bit b of word w set when slot 64w+b is taken
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_slot_table(struct slot_table* t, int num_slots);
+void free_slot_table(struct slot_table* t);
+int allocate_slot(struct slot_table* t);
+void release_slot(struct slot_table* t, int slot);
+
+#endif
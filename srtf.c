@@ -0,0 +1,15 @@
+#include "srtf.h"
+
+/**
+ * Predicts the next burst of a process by exponential averaging:
+ * tau(n+1) = alpha * t(n) + (1 - alpha) * tau(n), with alpha = 1/2.
+ *
+ * @param prediction The prediction for the burst that just ended
+ * @param last_burst_time How long that burst really was (in nanoseconds)
+ * @return The prediction for the next burst (in nanoseconds)
+ */
+uint64_t srtf_get_next_prediction(uint64_t prediction,
+                                  unsigned int last_burst_time) {
+  return prediction - (prediction >> SRTF_ALPHA_SHIFT) +
+         (last_burst_time >> SRTF_ALPHA_SHIFT);
+}
@@ -0,0 +1,34 @@
+#ifndef SRTF_H
+#define SRTF_H
+
+#include "myclock.h"
+
+/**
+ * Shortest Remaining Time First
+ *
+ * Ready processes are kept in a heap run queue, see heaprq.h,
+ * keyed on how long they are expected to run for.
+ */
+
+/*************
+ * CONSTANTS *
+ *************/
+
+// Predicted length of a new process's first burst
+#define SRTF_INITIAL_PREDICTION 50000000 // 50 milliseconds in nanoseconds
+
+// The next prediction is the last burst weighted by 1 / 2^SRTF_ALPHA_SHIFT
+// plus the last prediction weighted by the rest
+#define SRTF_ALPHA_SHIFT 1
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+uint64_t srtf_get_next_prediction(uint64_t prediction,
+                                  unsigned int last_burst_time);
+
+#endif
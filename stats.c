@@ -0,0 +1,34 @@
+#include <math.h>
+#include "stats.h"
+
+void init_running_stats(struct running_stats* s) {
+  s->count = 0;
+  s->mean = 0;
+  s->m2 = 0;
+  s->min = 0;
+  s->max = 0;
+}
+
+void stats_add(struct running_stats* s, double value) {
+  s->count++;
+  double delta = value - s->mean;
+  s->mean += delta / s->count;
+  s->m2 += delta * (value - s->mean);
+  if (s->count == 1 || value < s->min) {
+    s->min = value;
+  }
+  if (s->count == 1 || value > s->max) {
+    s->max = value;
+  }
+}
+
+/**
+ * @return The population variance, or 0 before any values.
+ */
+double stats_get_variance(const struct running_stats* s) {
+  return s->count > 0 ? s->m2 / s->count : 0;
+}
+
+double stats_get_stddev(const struct running_stats* s) {
+  return sqrt(stats_get_variance(s));
+}
@@ -0,0 +1,36 @@
+#ifndef STATS_H
+#define STATS_H
+
+/**
+ * Running Statistics
+ *
+ * Count, mean, variance, minimum and maximum of a stream of values,
+ * updated in O(1) per value with Welford's method, so they're
+ * correct at any point of a run without keeping the values.
+ */
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct running_stats {
+  unsigned long count;
+  double mean;
+  double m2;                // Sum of squared differences from the mean
+  double min;
+  double max;
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void init_running_stats(struct running_stats* s);
+void stats_add(struct running_stats* s, double value);
+double stats_get_variance(const struct running_stats* s);
+double stats_get_stddev(const struct running_stats* s);
+
+#endif
@@ -2,46 +2,146 @@
 #define STRUCTS_H
 
 #include "myclock.h"
+#include "logring.h"
 
 /**************
  * STRUCTURES *
  **************/
 
+/*
+ * Process Classes
+ * oss picks a class for every process it generates,
+ * or takes it from the workload it replays.
+ * -------------------------------------------------*/
+enum proc_class {
+  CLASS_INTERACTIVE,
+  CLASS_NORMAL,
+  CLASS_BATCH,
+  NUM_PROC_CLASSES
+};
+
+
 /*
  * Process Control Block (PCB)
  * Contains information for scheduling child processes.
- * ----------------------------------------------------*/
+ *
+ * The fields a user process writes during a burst come first, and
+ * the ones oss writes start on a cache line of their own after them.
+ * The log ring keeps the read index oss writes on a line of its own
+ * too. Every PCB is padded to whole cache lines, so processes running
+ * at the same time on different cores never write to the same line,
+ * and oss only writes to a running process's lines to hand it work.
+ * ---------------------------------------------------------------*/
 struct pcb {
-  // Total CPU time used
-  struct my_clock total_cpu_time;
+  /*
+   * Written by the user process
+   */
+
+  // Total CPU time used (in nanoseconds)
+  uint64_t total_cpu_time;
 
-  // Total time in the system
-  struct my_clock total_sys_time;
+  // How long to wait for an event after the last burst (in nanoseconds)
+  uint64_t event_wait_time;
 
   // Time used during the last burst in nanoseconds
   unsigned int last_burst_time;
 
-  int priority;
+  // Time left to run if process was interrupted
+  unsigned int remaining_time; // (in nanoseconds)
 
   // Flag signaling if the program was interrupted
   unsigned char was_interrupted;
 
-  // Time left to run if process was interrupted
-  unsigned int remaining_time; // (in nanoseconds)
-
   // Flag signaling process is ready to terminate
   unsigned char ready_to_terminate;
-};
+
+  // Log messages from the process, drained by oss
+  struct log_ring log;
+
+  /*
+   * Written by oss
+   */
+
+  // Bumped by oss every time the slot is given to a new process
+  unsigned int generation __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  // Set by oss to retire the user process in this slot
+  unsigned char should_exit;
+
+  // Futex wait word set by oss when this process is dispatched,
+  // and reset by the process when it wakes
+  int wait_word;
+
+  // Futex wait word set by oss when it gives this slot to
+  // the pooled worker serving it, see -u
+  int start_word;
+
+  // When oss generated the process
+  uint64_t created_at;
+
+  // Queue the process is in
+  int priority;
+
+  // CPU whose queues the process is in, or last ran on
+  int cpu;
+
+  // Time spent in the ready queue before the last burst (in nanoseconds)
+  uint64_t last_wait_time;
+
+  // Weighted CPU time, used by the completely fair scheduler (in nanoseconds)
+  uint64_t vruntime;
+
+  // Share of the CPU under the completely fair scheduler, see cfs.h
+  unsigned int weight;
+
+  // Expected length of the next burst, see srtf.h (in nanoseconds)
+  uint64_t predicted_burst;
+
+  // See enum proc_class
+  int proc_class;
+
+  // Share of the CPU under lottery and stride scheduling, see lottery.h
+  unsigned int tickets;
+
+  // Stride scheduling pass value
+  uint64_t pass;
+
+  // Flag signaling the process is in the earliest deadline first class
+  unsigned char is_realtime;
+
+  // Time between releases of a real-time process's jobs (in nanoseconds)
+  uint64_t period;
+
+  // Time a job has to finish after its release (in nanoseconds)
+  uint64_t relative_deadline;
+
+  // When the current job was released, and when it's due
+  uint64_t release_time;
+  uint64_t deadline;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
 
 
 /*
  * Currently Scheduled Process
- * Contains information for the currently scheduled process.
+ * Contains information for the process scheduled on one CPU.
+ * There is one per CPU, so processes on different CPUs run
+ * at the same time. Each is on a cache line of its own.
  * ---------------------------------------------------------*/
 struct curr_sched {
   unsigned int proc_id;        // The currently scheduled process
   unsigned int time_quantum;   // An indivisable amount of time to run for
   unsigned int rand_sched_num; // See get_rand_sched_num() for details
-};
+  uint64_t dispatched_at;      // When the process was dispatched (in nanoseconds)
+
+  // Under -w, the burst to run rather than drawing one, see replay_burst()
+  unsigned char is_replay;
+  unsigned char is_last_burst; // Terminate after it
+  unsigned int burst_time;     // Time to run for (in nanoseconds)
+  unsigned int burst_left;     // CPU time the workload's burst needs after that
+  uint64_t io_wait;            // Time to wait for I/O after it (in nanoseconds)
+
+  // Futex wait word set by the process when it has reported its burst
+  int done_word;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
 
 #endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "trace.h"
+#include "myclock.h"
+
+#define INITIAL_TRACE_SIZE (1 << 20) // 1 MiB
+
+static void map_trace(struct trace* t, size_t size);
+static const char* get_queue_name(uint32_t queue, char buf[24]);
+
+/**
+ * Creates a trace file and writes its header.
+ *
+ * @param t The trace
+ * @param path Where to write the trace
+ * @param num_levels Number of ready queues, so ossdump can rebuild them
+ * @param num_procs Number of process control blocks
+ * @param num_cpus Number of simulated CPUs
+ * @param policy Scheduling policy, see enum sched_policy
+ */
+void open_trace(struct trace* t, const char* path, int num_levels,
+                int num_procs, int num_cpus, int policy) {
+  t->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (t->fd == -1) {
+    perror("Failed to open trace file");
+    exit(EXIT_FAILURE);
+  }
+  t->map = NULL;
+  t->size = 0;
+  map_trace(t, INITIAL_TRACE_SIZE);
+
+  struct trace_header header;
+  memset(&header, 0, sizeof(header));
+  header.magic = TRACE_MAGIC;
+  header.version = TRACE_VERSION;
+  header.record_size = sizeof(struct trace_record);
+  header.num_levels = num_levels;
+  header.num_procs = num_procs;
+  header.num_cpus = num_cpus;
+  header.policy = policy;
+  memcpy(t->map, &header, sizeof(header));
+  t->length = sizeof(header);
+}
+
+/**
+ * Trims the trace file to what was written and closes it.
+ */
+void close_trace(struct trace* t) {
+  munmap(t->map, t->size);
+  if (ftruncate(t->fd, t->length) == -1) {
+    perror("Failed to trim trace file");
+  }
+  close(t->fd);
+}
+
+/**
+ * Appends a record to the trace. The mapping doubles in size
+ * whenever it fills up, so appends are amortized O(1).
+ */
+void write_trace(struct trace* t, uint64_t time, int type, int proc_id,
+                 uint64_t arg) {
+  if (t->length + sizeof(struct trace_record) > t->size) {
+    map_trace(t, t->size * 2);
+  }
+  struct trace_record* rec = (struct trace_record*) (t->map + t->length);
+  rec->time = time;
+  rec->type = type;
+  rec->proc_id = proc_id;
+  rec->arg = arg;
+  t->length += sizeof(struct trace_record);
+}
+
+/**
+ * Names a ready queue for the log, like "queue 2".
+ *
+ * @param queue The queue number, or TR_REALTIME_QUEUE
+ * @param buf Where to format a numbered queue's name
+ * @return The name
+ */
+static const char* get_queue_name(uint32_t queue, char buf[24]) {
+  if (queue == TR_REALTIME_QUEUE) {
+    return "the real-time queue";
+  }
+  sprintf(buf, "queue %d", (int) queue);
+  return buf;
+}
+
+/**
+ * Prints the log line for a record, if it has one.
+ * Enqueues only change the queues, see print_ready_queues().
+ * CPUs are only mentioned when there is more than one.
+ */
+void print_trace_record(FILE* fp, const struct trace_record* rec,
+                        int num_cpus) {
+  struct my_clock time = get_clock_view(rec->time);
+  struct my_clock until;
+  char queue[24];
+  int64_t lateness;
+  switch (rec->type) {
+    case TR_GENERATE:
+      fprintf(fp, "[OSS] [%02d:%010d] Generating process %d and putting it in %s\n",
+              time.secs, time.nanosecs, rec->proc_id,
+              get_queue_name(rec->arg, queue));
+      break;
+    case TR_DISPATCH:
+      if (num_cpus > 1) {
+        fprintf(fp, "[OSS] [%02d:%010d] Dispatching process %d from %s of CPU %d\n",
+                time.secs, time.nanosecs, rec->proc_id,
+                get_queue_name(rec->arg & 0xffffffff, queue),
+                (int) (rec->arg >> 32));
+      } else {
+        fprintf(fp, "[OSS] [%02d:%010d] Dispatching process %d from %s\n",
+                time.secs, time.nanosecs, rec->proc_id,
+                get_queue_name(rec->arg & 0xffffffff, queue));
+      }
+      break;
+    case TR_BURST_END:
+      fprintf(fp, "[OSS] [%02d:%010d] Process %d ran for %d nanoseconds during last burst.\n",
+              time.secs, time.nanosecs, rec->proc_id, (int) rec->arg);
+      break;
+    case TR_REQUEUE:
+      fprintf(fp, "[OSS] [%02d:%010d] Putting process %d in %s.\n",
+              time.secs, time.nanosecs, rec->proc_id,
+              get_queue_name(rec->arg, queue));
+      break;
+    case TR_MOVE:
+      fprintf(fp, "[OSS] [%02d:%010d] Moving process %d from queue %d to queue %d.\n",
+              time.secs, time.nanosecs, rec->proc_id,
+              (int) (rec->arg >> 32), (int) (rec->arg & 0xffffffff));
+      break;
+    case TR_EVENT_WAIT:
+      until = get_clock_view(rec->arg);
+      fprintf(fp, "[OSS] [%02d:%010d] Process %d waiting for an event until %02d:%010d.\n",
+              time.secs, time.nanosecs, rec->proc_id, until.secs, until.nanosecs);
+      break;
+    case TR_EVENT_WAKEUP:
+      fprintf(fp, "[OSS] [%02d:%010d] Process %d finished waiting for an event. Putting it in %s.\n",
+              time.secs, time.nanosecs, rec->proc_id,
+              get_queue_name(rec->arg, queue));
+      break;
+    case TR_TERMINATE:
+      fprintf(fp, "[OSS] [%02d:%010d] Process %d terminated. Number of processes completed %lld\n",
+              time.secs, time.nanosecs, rec->proc_id, (long long) rec->arg);
+      break;
+    case TR_STEAL:
+      fprintf(fp, "[OSS] [%02d:%010d] CPU %d is idle, stealing process %d from CPU %d\n",
+              time.secs, time.nanosecs, (int) (rec->arg & 0xffffffff),
+              rec->proc_id, (int) (rec->arg >> 32));
+      break;
+    case TR_PREEMPT:
+      fprintf(fp, "[OSS] [%02d:%010d] Preempting process %d after %d nanoseconds for process %d\n",
+              time.secs, time.nanosecs, rec->proc_id,
+              (int) (rec->arg & 0xffffffff), (int) (rec->arg >> 32));
+      break;
+    case TR_RELEASE:
+      until = get_clock_view(rec->arg);
+      fprintf(fp, "[OSS] [%02d:%010d] Releasing a job of real-time process %d, due at %02d:%010d\n",
+              time.secs, time.nanosecs, rec->proc_id, until.secs, until.nanosecs);
+      break;
+    case TR_JOB_END:
+      lateness = (int64_t) rec->arg;
+      if (lateness > 0) {
+        fprintf(fp, "[OSS] [%02d:%010d] Real-time process %d missed its deadline by %lld nanoseconds\n",
+                time.secs, time.nanosecs, rec->proc_id, (long long) lateness);
+      } else {
+        fprintf(fp, "[OSS] [%02d:%010d] Real-time process %d met its deadline with %lld nanoseconds to spare\n",
+                time.secs, time.nanosecs, rec->proc_id, (long long) -lateness);
+      }
+      break;
+    case TR_USR_WAITING:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d waiting in ready queue\n",
+              time.secs, time.nanosecs, rec->proc_id);
+      break;
+    case TR_USR_SCHEDULED:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d scheduled to run for %d nanoseconds\n",
+              time.secs, time.nanosecs, rec->proc_id, (int) rec->arg);
+      break;
+    case TR_USR_RESUMING:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d resuming. Scheduled to run for %d nanoseconds\n",
+              time.secs, time.nanosecs, rec->proc_id, (int) rec->arg);
+      break;
+    case TR_USR_EVENT:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d was interrupted by an event for %d:%d after running for %d nanoseconds\n",
+              time.secs, time.nanosecs, rec->proc_id, (int) (rec->arg >> 48),
+              (int) ((rec->arg >> 32) & 0xffff), (int) (rec->arg & 0xffffffff));
+      break;
+    case TR_USR_PREEMPTED:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d was preempted after running for %d nanoseconds\n",
+              time.secs, time.nanosecs, rec->proc_id, (int) rec->arg);
+      break;
+    case TR_USR_TERMINATING:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d ready to terminate\n",
+              time.secs, time.nanosecs, rec->proc_id);
+      break;
+    case TR_USR_NOT_TERMINATING:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d NOT ready to terminate\n",
+              time.secs, time.nanosecs, rec->proc_id);
+      break;
+    case TR_USR_IO_WAIT:
+      fprintf(fp, "[USR] [%02d:%010d] Process %d waits %u microseconds for I/O after running for %d nanoseconds\n",
+              time.secs, time.nanosecs, rec->proc_id, (unsigned int) (rec->arg >> 32),
+              (int) (rec->arg & 0xffffffff));
+      break;
+  }
+}
+
+/**
+ * Prints every ready queue of a CPU from back to front.
+ */
+void print_ready_queues(FILE* fp, int cpu, int num_cpus,
+                        struct ready_queue* levels, int num_levels,
+                        struct ready_links* links) {
+  int i;
+  for (i = 0; i < num_levels; i++) {
+    int proc_id;
+    if (num_cpus > 1) {
+      fprintf(fp, "[OSS] CPU %d Queue %d: [ ", cpu, i + 1);
+    } else {
+      fprintf(fp, "[OSS] Queue %d: [ ", i + 1);
+    }
+    for (proc_id = levels[i].tail; proc_id != -1; proc_id = links->prev[proc_id])
+        fprintf(fp, "%d ", proc_id);
+
+    fprintf(fp, "]\n");
+  }
+}
+
+static void map_trace(struct trace* t, size_t size) {
+  if (t->map != NULL) {
+    munmap(t->map, t->size);
+  }
+  if (ftruncate(t->fd, size) == -1) {
+    perror("Failed to grow trace file");
+    exit(EXIT_FAILURE);
+  }
+  t->map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, t->fd, 0);
+  if (t->map == MAP_FAILED) {
+    perror("Failed to map trace file");
+    exit(EXIT_FAILURE);
+  }
+  t->size = size;
+}
@@ -0,0 +1,94 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "readyq.h"
+
+/**
+ * Binary Trace
+ *
+ * oss describes everything it does as fixed-size records appended
+ * to a memory-mapped file. ossdump turns a trace back into the
+ * human-readable log, using the same formatting as oss itself.
+ */
+
+#define TRACE_MAGIC 0x454341525453534fULL // "OSSTRACE" in little-endian
+#define TRACE_VERSION 5
+
+// Queue number of the earliest deadline first queue
+#define TR_REALTIME_QUEUE 0xffffffffU
+
+/**************
+ * STRUCTURES *
+ **************/
+
+enum trace_type {
+  TR_GENERATE,      // arg: queue the new process goes in
+  TR_ENQUEUE,       // arg: CPU << 32 | queue (TR_REALTIME_QUEUE for real-time processes)
+  TR_DISPATCH,      // arg: CPU << 32 | queue the process was taken from
+  TR_BURST_END,     // arg: length of the burst (in nanoseconds)
+  TR_REQUEUE,       // arg: queue the process goes back into
+  TR_MOVE,          // arg: old queue << 32 | new queue
+  TR_EVENT_WAIT,    // arg: time the event is over (in nanoseconds)
+  TR_EVENT_WAKEUP,  // arg: queue the process goes back into
+  TR_TERMINATE,     // arg: number of processes completed
+  TR_STEAL,         // arg: CPU stolen from << 32 | CPU stealing
+  TR_PREEMPT,       // arg: arriving process << 32 | time ran for (in nanoseconds)
+  TR_RELEASE,       // arg: deadline of the released job (in nanoseconds)
+  TR_JOB_END,       // arg: lateness of the job (in nanoseconds, negative if early)
+
+  // Written by user processes, see logring.h
+  TR_USR_WAITING,         // arg: unused
+  TR_USR_SCHEDULED,       // arg: time to run for (in nanoseconds)
+  TR_USR_RESUMING,        // arg: time to run for (in nanoseconds)
+  TR_USR_EVENT,           // arg: wait secs << 48 | wait nanosecs << 32 | time ran for
+  TR_USR_PREEMPTED,       // arg: time ran for (in nanoseconds)
+  TR_USR_TERMINATING,     // arg: unused
+  TR_USR_NOT_TERMINATING, // arg: unused
+  TR_USR_IO_WAIT          // arg: wait (in microseconds) << 32 | time ran for
+};
+
+struct trace_header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t num_levels;    // Number of ready queues
+  uint32_t num_procs;     // Number of process control blocks
+  uint32_t num_cpus;      // Number of simulated CPUs, each with its own queues
+  uint32_t policy;        // See enum sched_policy
+};
+
+struct trace_record {
+  uint64_t time;          // Simulated time (in nanoseconds)
+  uint32_t type;          // See enum trace_type
+  int32_t proc_id;
+  uint64_t arg;           // Meaning depends on type
+};
+
+struct trace {
+  int fd;
+  char* map;
+  size_t size;            // Size of the mapping
+  size_t length;          // Bytes written so far
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void open_trace(struct trace* t, const char* path, int num_levels,
+                int num_procs, int num_cpus, int policy);
+void close_trace(struct trace* t);
+void write_trace(struct trace* t, uint64_t time, int type, int proc_id,
+                 uint64_t arg);
+void print_trace_record(FILE* fp, const struct trace_record* rec,
+                        int num_cpus);
+void print_ready_queues(FILE* fp, int cpu, int num_cpus,
+                        struct ready_queue* levels, int num_levels,
+                        struct ready_links* links);
+
+#endif
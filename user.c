@@ -5,194 +5,83 @@
 #include <unistd.h>
 #include <string.h>
 #include <sys/time.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
 #include <sys/stat.h>
 #include <sys/prctl.h>
 #include <time.h>
-#include "sem.h"
 #include "structs.h"
 #include "ossshm.h"
 #include "myclock.h"
+#include "futex.h"
+#include "logring.h"
+#include "usersim.h"
 
-#define FIFTY_MILLISECS 50000000 // 50 milliseconds in nano seconds
-
-int at_least_fifty_millisecs(struct my_clock a);
+static void run_process(int proc_id, uint64_t seed, struct pcb* pcb_shm,
+                        struct curr_sched* curr_sched_shm);
 
 int main(int argc, char* argv[]) {
-  if (argc != 6) {
-    fprintf(
-      stderr,
-      "Usage: %s proc_id clock_seg_id pcb_seg_id curr_sched_seg_id sem_id\n",
-      argv[0]
-    );
+  int is_worker = argc == 5 && strcmp(argv[4], "pool") == 0;
+  if (argc != 4 && !is_worker) {
+    fprintf(stderr, "Usage: %s proc_id shm_name seed [pool]\n", argv[0]);
     return EXIT_FAILURE;
   }
 
-  srand(time(NULL));
-
   const int proc_id = atoi(argv[1]);
-  const int clock_seg_id = atoi(argv[2]);
-  const int pcb_seg_id = atoi(argv[3]);
-  const int curr_sched_seg_id = atoi(argv[4]);
-  const int sem_id = atoi(argv[5]);
-
-  struct my_clock* clock_shm = attach_to_clock_shm(clock_seg_id);
-  struct pcb* pcb_shm = attach_to_pcb_shm(pcb_seg_id);
-  struct curr_sched* curr_sched_shm = attach_to_curr_sched_shm(curr_sched_seg_id);
-
-  int is_process_complete = 0;
-  pcb_shm[proc_id].ready_to_terminate = 0;
-  do {
-    struct my_clock start_time;
-    start_time.secs = clock_shm->secs;
-    start_time.nanosecs = clock_shm->nanosecs;
-
-    printf(
-      "[USR] [%02d:%010d] Process %d waiting in ready queue\n",
-      clock_shm->secs,
-      clock_shm->nanosecs,
-      proc_id
-    );
-
-    // Wait to be scheduled
-    while (curr_sched_shm->proc_id != proc_id);
-
-    int should_use_full_time_quantum = rand() % 2;
-
-    unsigned int time_quantum;
-    if (pcb_shm[proc_id].was_interrupted) {
-      pcb_shm[proc_id].was_interrupted = 0;
-      time_quantum = pcb_shm[proc_id].remaining_time;
-      pcb_shm[proc_id].remaining_time = 0;
-      printf(
-        "[USR] [%02d:%010d] Process %d resuming. Scheduled to run for %d nanoseconds\n",
-        clock_shm->secs,
-        clock_shm->nanosecs,
-        proc_id,
-        time_quantum
-      );
-    } else if (should_use_full_time_quantum) {
-      time_quantum = curr_sched_shm->time_quantum;
-      printf(
-        "[USR] [%02d:%010d] Process %d scheduled to run for %d nanoseconds\n",
-        clock_shm->secs,
-        clock_shm->nanosecs,
-        proc_id,
-        time_quantum
-      );
-    } else { // Use partial time quantum
-      time_quantum = rand() % curr_sched_shm->time_quantum;
-      printf(
-        "[USR] [%02d:%010d] Process %d scheduled to run for %d nanoseconds\n",
-        clock_shm->secs,
-        clock_shm->nanosecs,
-        proc_id,
-        time_quantum
-      );
+  const char* shm_name = argv[2];
+  const uint64_t seed = strtoull(argv[3], NULL, 10);
+
+  struct oss_shm shm;
+  attach_to_oss_shm(&shm, shm_name);
+  struct pcb* pcb_shm = shm.pcbs;
+  struct curr_sched* curr_sched_shm = shm.curr_sched;
+
+  // Nothing would ever dispatch it if oss were killed
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+  if (is_worker) {
+    // A pooled worker runs every process oss puts in its slot
+    while (1) {
+      wakeup_wait(&pcb_shm[proc_id].start_word);
+      if (pcb_shm[proc_id].should_exit) {
+        break;
+      }
+      run_process(proc_id, seed, pcb_shm, curr_sched_shm);
     }
+  } else {
+    run_process(proc_id, seed, pcb_shm, curr_sched_shm);
+  }
 
-    // Wait for an event
-    if (curr_sched_shm->rand_sched_num == 2) {
-      int time_ran_for = rand() % time_quantum;
-      int time_left_to_run = time_quantum - time_ran_for;
-      pcb_shm[proc_id].was_interrupted = 1;
-      pcb_shm[proc_id].remaining_time = time_left_to_run;
-      time_quantum = time_ran_for;
+  detach_from_oss_shm(&shm);
 
-      // Add wait time to total system time
-      struct my_clock wait_time;
-      wait_time.secs = rand() % 6;
-      wait_time.nanosecs = rand() % 1001;
-      pcb_shm[proc_id].total_sys_time = add_clocks(
-        pcb_shm[proc_id].total_sys_time,
-        wait_time
-      );
+  return EXIT_SUCCESS;
+}
 
-      printf(
-        "[USR] [%02d:%010d] Process %d was interrupted by an event for %d:%d after running for %d nanoseconds\n",
-        clock_shm->secs,
-        clock_shm->nanosecs,
-        proc_id,
-        wait_time.secs,
-        wait_time.nanosecs,
-        time_ran_for
-      );
-    }
+/**
+ * Runs the simulated process in a PCB slot until it
+ * terminates, or oss retires it.
+ *
+ * @param proc_id The process's PCB slot
+ * @param seed Seed of the run, see -s
+ * @param pcb_shm The process control blocks
+ * @param curr_sched_shm What each CPU is running
+ */
+static void run_process(int proc_id, uint64_t seed, struct pcb* pcb_shm,
+                        struct curr_sched* curr_sched_shm) {
+  struct user_proc u;
+  user_start(&u, proc_id, &pcb_shm[proc_id], seed);
 
-    // Preempted after using [1, 99] of time quantum
-    if (curr_sched_shm->rand_sched_num == 3) {
-      int time_ran_for = rand() % 99 + 1;
-      int time_left_to_run = time_quantum - time_ran_for;
-      pcb_shm[proc_id].was_interrupted = 1;
-      pcb_shm[proc_id].remaining_time = time_left_to_run;
-      time_quantum = time_ran_for;
-      printf(
-        "[USR] [%02d:%010d] Process %d was preempted after running for %d nanoseconds\n",
-        clock_shm->secs,
-        clock_shm->nanosecs,
-        proc_id,
-        time_ran_for
-      );
+  int is_process_complete = 0;
+  do {
+    // Sleep until oss dispatches this process
+    wakeup_wait(&pcb_shm[proc_id].wait_word);
+    if (pcb_shm[proc_id].should_exit) {
+      return;
     }
 
-    struct my_clock end_time = add_nanosecs_to_clock(*clock_shm, time_quantum);
-
-    struct my_clock total_sys_time;
-    total_sys_time = subtract_clocks(end_time, start_time);
-
-    pcb_shm[proc_id].total_sys_time = add_clocks(
-                                        pcb_shm[proc_id].total_sys_time,
-                                        total_sys_time
-                                      );
-
-    pcb_shm[proc_id].total_cpu_time = add_nanosecs_to_clock(
-                                        pcb_shm[proc_id].total_cpu_time,
-                                        time_quantum
-                                      );
-
-    pcb_shm[proc_id].last_burst_time = time_quantum;
-
-    // AND proccess is supposed to execute normally
-    if (at_least_fifty_millisecs(pcb_shm[proc_id].total_cpu_time) &&
-        curr_sched_shm->rand_sched_num == 1) {
-      is_process_complete = rand() % 2;
-      if (is_process_complete) {
-        pcb_shm[proc_id].ready_to_terminate = 1;
-        printf(
-          "[USR] [%02d:%010d] Process %d ready to terminate\n",
-          clock_shm->secs,
-          clock_shm->nanosecs,
-          proc_id
-        );
-      }
-    }
+    struct curr_sched* sched = &curr_sched_shm[pcb_shm[proc_id].cpu];
+    is_process_complete = user_run_burst(&u, sched);
 
     // Set to a value that won't be equal to a process ID
-    curr_sched_shm->proc_id = -10;
-    sem_post(sem_id);
-
-    if (!is_process_complete) {
-      printf(
-        "[USR] [%02d:%010d] Process %d NOT ready to terminate\n",
-        clock_shm->secs,
-        clock_shm->nanosecs,
-        proc_id
-      );
-    }
+    sched->proc_id = -10;
+    wakeup_post(&sched->done_word);
   } while (!is_process_complete);
-
-  detach_from_clock_shm(clock_shm);
-  detach_from_pcb_shm(pcb_shm);
-  detach_from_curr_sched_shm(curr_sched_shm);
-
-  return EXIT_SUCCESS;
 }
-
-int at_least_fifty_millisecs(struct my_clock a) {
-  if (a.secs > 0 || a.nanosecs >= FIFTY_MILLISECS) {
-    return 1;
-  } else {
-    return 0;
-  }
-}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "usersim.h"
+#include "myclock.h"
+#include "logring.h"
+
+#define FIFTY_MILLISECS 50000000 // 50 milliseconds in nano seconds
+
+/**
+ * Starts the process oss just created in a PCB slot.
+ *
+ * @param u The process's state between bursts
+ * @param proc_id The process's PCB slot
+ * @param pcb The process's PCB
+ * @param seed Seed of the run, see -s
+ */
+void user_start(struct user_proc* u, int proc_id, struct pcb* pcb,
+                uint64_t seed) {
+  u->proc_id = proc_id;
+  u->pcb = pcb;
+  // A stream of its own, so its draws don't depend on when it started
+  rng_seed(&u->rng, seed, RNG_STREAM_PROC(proc_id, pcb->generation));
+
+  // Logged at the time oss created this process rather than whenever
+  // the host got around to starting it, so runs can be repeated
+  push_log_record(&pcb->log, pcb->created_at, TR_USR_WAITING, proc_id, 0);
+  pcb->ready_to_terminate = 0;
+}
+
+static int replay_burst(struct user_proc* u, struct curr_sched* sched);
+
+/**
+ * Runs the burst oss dispatched the process for, deciding how much
+ * of its quantum it uses, whether it then waits for an event or is
+ * preempted, and whether it terminates.
+ *
+ * @param u The process's state between bursts
+ * @param sched The CPU the process was dispatched on
+ * @return 1 when the process terminates and 0 otherwise.
+ */
+int user_run_burst(struct user_proc* u, struct curr_sched* sched) {
+  struct pcb* pcb = u->pcb;
+  struct log_ring* log = &pcb->log;
+  int proc_id = u->proc_id;
+  int is_complete = 0;
+  struct my_clock wait_time;
+
+  // oss may dispatch on other CPUs before this process reads the
+  // clock, so its messages use the time it was dispatched at
+  uint64_t now = sched->dispatched_at;
+
+  if (sched->is_replay) {
+    return replay_burst(u, sched);
+  }
+
+  int should_use_full_time_quantum = rng_below(&u->rng, 2);
+
+  unsigned int time_quantum;
+  if (pcb->was_interrupted) {
+    pcb->was_interrupted = 0;
+    time_quantum = pcb->remaining_time;
+    pcb->remaining_time = 0;
+    push_log_record(log, now, TR_USR_RESUMING, proc_id, time_quantum);
+  } else if (should_use_full_time_quantum) {
+    time_quantum = sched->time_quantum;
+    push_log_record(log, now, TR_USR_SCHEDULED, proc_id, time_quantum);
+  } else { // Use partial time quantum
+    time_quantum = rng_below(&u->rng, sched->time_quantum);
+    push_log_record(log, now, TR_USR_SCHEDULED, proc_id, time_quantum);
+  }
+
+  // Wait for an event
+  if (sched->rand_sched_num == 2 && time_quantum > 0) {
+    unsigned int time_ran_for = rng_below(&u->rng, time_quantum);
+    unsigned int time_left_to_run = time_quantum - time_ran_for;
+    pcb->was_interrupted = 1;
+    pcb->remaining_time = time_left_to_run;
+    time_quantum = time_ran_for;
+
+    // oss keeps this process blocked for the wait time
+    wait_time.secs = rng_below(&u->rng, 6);
+    wait_time.nanosecs = rng_below(&u->rng, 1001);
+    pcb->event_wait_time = wait_time.secs * NANOSECS_PER_SEC +
+                           wait_time.nanosecs;
+
+    push_log_record(log, now, TR_USR_EVENT, proc_id,
+                    (uint64_t) wait_time.secs << 48 |
+                    (uint64_t) wait_time.nanosecs << 32 |
+                    (uint32_t) time_ran_for);
+  }
+
+  // Preempted after using [1, 99] of time quantum, but never more
+  // than oss handed out, which a partial quantum may be less than
+  if (sched->rand_sched_num == 3 && time_quantum > 0) {
+    unsigned int max_ran_for = time_quantum < 99 ? time_quantum : 99;
+    unsigned int time_ran_for = rng_below(&u->rng, max_ran_for) + 1;
+    unsigned int time_left_to_run = time_quantum - time_ran_for;
+    pcb->was_interrupted = 1;
+    pcb->remaining_time = time_left_to_run;
+    time_quantum = time_ran_for;
+    push_log_record(log, now, TR_USR_PREEMPTED, proc_id, time_ran_for);
+  }
+
+  pcb->total_cpu_time += time_quantum;
+
+  pcb->last_burst_time = time_quantum;
+
+  // AND proccess is supposed to execute normally
+  if (pcb->total_cpu_time >= FIFTY_MILLISECS &&
+      sched->rand_sched_num == 1) {
+    is_complete = rng_below(&u->rng, 2);
+    if (is_complete) {
+      pcb->ready_to_terminate = 1;
+      push_log_record(log, now, TR_USR_TERMINATING, proc_id, 0);
+    }
+  }
+
+  // Logged before handing the CPU back, so oss drains
+  // them along with the rest of this burst
+  if (!is_complete) {
+    push_log_record(log, now, TR_USR_NOT_TERMINATING, proc_id, 0);
+    push_log_record(log, now, TR_USR_WAITING, proc_id, 0);
+  }
+  return is_complete;
+}
+
+/**
+ * Runs the burst of a replayed workload that oss dispatched the
+ * process for. oss has already worked out from the workload how
+ * long it runs and what it does next, so nothing is drawn.
+ *
+ * @param u The process's state between bursts
+ * @param sched The CPU the process was dispatched on
+ * @return 1 when the process terminates and 0 otherwise.
+ */
+static int replay_burst(struct user_proc* u, struct curr_sched* sched) {
+  struct pcb* pcb = u->pcb;
+  struct log_ring* log = &pcb->log;
+  int proc_id = u->proc_id;
+  uint64_t now = sched->dispatched_at;
+  unsigned int time_quantum = sched->burst_time;
+
+  push_log_record(log, now, pcb->was_interrupted ? TR_USR_RESUMING
+                                                 : TR_USR_SCHEDULED,
+                  proc_id, time_quantum);
+  pcb->was_interrupted = 0;
+  pcb->remaining_time = 0;
+
+  if (sched->burst_left > 0) {
+    // Used up its quantum with the burst still unfinished
+    pcb->was_interrupted = 1;
+    pcb->remaining_time = sched->burst_left;
+    push_log_record(log, now, TR_USR_PREEMPTED, proc_id, time_quantum);
+  } else if (sched->io_wait > 0) {
+    pcb->event_wait_time = sched->io_wait;
+    push_log_record(log, now, TR_USR_IO_WAIT, proc_id,
+                    (sched->io_wait / 1000) << 32 | time_quantum);
+  }
+
+  pcb->total_cpu_time += time_quantum;
+  pcb->last_burst_time = time_quantum;
+
+  if (sched->is_last_burst) {
+    pcb->ready_to_terminate = 1;
+    push_log_record(log, now, TR_USR_TERMINATING, proc_id, 0);
+    return 1;
+  }
+  push_log_record(log, now, TR_USR_NOT_TERMINATING, proc_id, 0);
+  push_log_record(log, now, TR_USR_WAITING, proc_id, 0);
+  return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef USERSIM_H
+#define USERSIM_H
+
+#include <stdint.h>
+#include "structs.h"
+#include "rng.h"
+
+/**
+ * Simulated User Process
+ *
+ * What a user process does with a burst, shared by user and by
+ * oss's -u thread mode. A process only ever waits to be dispatched,
+ * so it runs as a coroutine without a stack of its own: everything
+ * it keeps between bursts is in struct user_proc, and each dispatch
+ * runs one burst to completion. When oss replays a workload, it
+ * says what the burst does instead of the process drawing it.
+ */
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct user_proc {
+  int proc_id;
+  struct pcb* pcb;
+  struct rng rng;
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void user_start(struct user_proc* u, int proc_id, struct pcb* pcb,
+                uint64_t seed);
+int user_run_burst(struct user_proc* u, struct curr_sched* sched);
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "workload.h"
+#include "structs.h"
+
+static const char* class_names[NUM_PROC_CLASSES] = {
+  [CLASS_INTERACTIVE] = "interactive",
+  [CLASS_NORMAL] = "normal",
+  [CLASS_BATCH] = "batch"
+};
+
+/**
+ * Maps a workload file and checks its header.
+ *
+ * @param w The workload
+ * @param path The file, written by osswl
+ */
+void open_workload(struct workload* w, const char* path) {
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    perror("Failed to open workload file");
+    exit(EXIT_FAILURE);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    perror("Failed to stat workload file");
+    exit(EXIT_FAILURE);
+  }
+  if (st.st_size < (off_t) sizeof(struct workload_header)) {
+    fprintf(stderr, "%s is too short to be a workload.\n", path);
+    exit(EXIT_FAILURE);
+  }
+  w->size = st.st_size;
+  w->map = mmap(NULL, w->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (w->map == MAP_FAILED) {
+    perror("Failed to map workload file");
+    exit(EXIT_FAILURE);
+  }
+  // Read mostly front to back, so read ahead generously
+  madvise((void*) w->map, w->size, MADV_SEQUENTIAL);
+
+  w->header = (const struct workload_header*) w->map;
+  if (w->header->magic != WORKLOAD_MAGIC ||
+      w->header->version != WORKLOAD_VERSION) {
+    fprintf(stderr, "%s is not a version %d workload.\n", path, WORKLOAD_VERSION);
+    exit(EXIT_FAILURE);
+  }
+  w->next = sizeof(struct workload_header);
+  w->num_procs_left = w->header->num_procs;
+  w->released = 0;
+  w->released_at = w->next;
+}
+
+void close_workload(struct workload* w) {
+  munmap((void*) w->map, w->size);
+}
+
+/**
+ * Takes the next process to arrive. Its bursts follow it
+ * in the file, starting at (struct workload_burst*) (proc + 1).
+ *
+ * @return The process, or NULL once every process has arrived.
+ */
+const struct workload_proc* next_workload_proc(struct workload* w) {
+  if (w->num_procs_left == 0) {
+    return NULL;
+  }
+  const struct workload_proc* proc =
+    (const struct workload_proc*) (w->map + w->next);
+  if (w->next + sizeof(*proc) > w->size ||
+      proc->num_bursts == 0 ||
+      (w->size - w->next - sizeof(*proc)) / sizeof(struct workload_burst) <
+        proc->num_bursts ||
+      proc->proc_class >= NUM_PROC_CLASSES) {
+    fprintf(stderr, "Workload is corrupt at byte %zu.\n", w->next);
+    exit(EXIT_FAILURE);
+  }
+  w->next += sizeof(*proc) + sizeof(struct workload_burst) * proc->num_bursts;
+  w->num_procs_left--;
+  return proc;
+}
+
+/**
+ * @return 1 once enough of the workload has been read since it was
+ *         last released to be worth finding the oldest process still
+ *         running, see release_workload(), and 0 otherwise.
+ */
+int should_release_workload(const struct workload* w) {
+  return w->next - w->released_at >= WORKLOAD_RELEASE_BYTES;
+}
+
+/**
+ * Gives the pages before the oldest part of the workload still
+ * needed back to the kernel, so the memory a replay uses doesn't
+ * grow with the length of the workload. They're read from the
+ * file again if they're ever touched.
+ *
+ * @param w The workload
+ * @param oldest The first byte still needed
+ */
+void release_workload(struct workload* w, const void* oldest) {
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t offset = (const char*) oldest - w->map;
+  offset -= offset % page_size;
+  w->released_at = w->next;
+  if (offset > w->released) {
+    madvise((void*) (w->map + w->released), offset - w->released,
+            MADV_DONTNEED);
+    w->released = offset;
+  }
+}
+
+/**
+ * @param name A process class, like "interactive"
+ * @return The class, see enum proc_class, or -1 if there's no such class.
+ */
+int get_proc_class_by_name(const char* name) {
+  int i;
+  for (i = 0; i < NUM_PROC_CLASSES; i++) {
+    if (strcmp(name, class_names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
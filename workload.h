@@ -0,0 +1,91 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Workload File
+ *
+ * A recorded workload for oss to replay instead of drawing
+ * arrivals and bursts at random, see -w. After the header come
+ * the processes in order of arrival, each followed by its bursts:
+ * the CPU time it needs, then how long it waits for I/O before
+ * it needs the CPU again. A process terminates after its last
+ * burst, so the I/O wait of the last burst is ignored.
+ *
+ * oss maps the file and reads it as the run goes, so a process
+ * only has to be in memory from its arrival until it terminates.
+ * osswl converts a CSV file to this format.
+ */
+
+/*************
+ * CONSTANTS *
+ *************/
+
+#define WORKLOAD_MAGIC 0x444c4b525753534fULL // "OSSWRKLD" in little-endian
+#define WORKLOAD_VERSION 1
+
+// The part of the file already replayed is given back to the
+// kernel in chunks of at least this many bytes
+#define WORKLOAD_RELEASE_BYTES (8 * 1024 * 1024)
+
+// =================================================================
+
+
+/**************
+ * STRUCTURES *
+ **************/
+
+struct workload_header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t num_procs;
+  uint64_t num_bursts;    // Over every process
+};
+
+struct workload_proc {
+  uint64_t arrival;       // Since the start of the run (in nanoseconds)
+  uint32_t num_bursts;    // At least one
+  uint32_t proc_class;    // See enum proc_class
+};
+
+struct workload_burst {
+  uint32_t cpu_time;      // In nanoseconds
+  uint32_t io_wait;       // In microseconds, to keep bursts small
+};
+
+struct workload {
+  const char* map;
+  size_t size;            // Size of the file
+  const struct workload_header* header;
+  size_t next;            // Offset of the next process to arrive
+  uint64_t num_procs_left;
+  size_t released;        // Bytes at the start given back to the kernel
+  size_t released_at;     // Value of next when last released
+};
+
+/*
+ * Where a process is in its bursts
+ * --------------------------------*/
+struct workload_cursor {
+  const struct workload_burst* next; // NULL once the process terminates
+  uint32_t num_bursts_left;          // Counting the next one
+};
+
+// =================================================================
+
+
+/**************
+ * PROTOTYPES *
+ **************/
+
+void open_workload(struct workload* w, const char* path);
+void close_workload(struct workload* w);
+const struct workload_proc* next_workload_proc(struct workload* w);
+int should_release_workload(const struct workload* w);
+void release_workload(struct workload* w, const void* oldest);
+int get_proc_class_by_name(const char* name);
+
+#endif